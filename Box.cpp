@@ -23,6 +23,8 @@ void Box::Initialize()
 	HalfSize.x = Side / 2;
 	HalfSize.y = Side / 2;
 	HalfSize.z = Side / 2;
+	// Penetrations up to about twice the margin get their normal from the cores instead of EPA
+	CollisionMargin = 0.04f;
 
 	// Initialize inertia tensor of a symmetric rectangular prism in body space:
 	// http://www-robotics.cs.umass.edu/~grupen/603/slides/DynamicsI.pdf
@@ -41,10 +43,8 @@ void Box::Initialize()
 
 glm::vec3 Box::FindFarthestPointInDirection(vector3 aDirection)
 {
-	Transform * transform = pOwner->GetComponent<Transform>();
-
 	// To deal with rotations, convert the direction to local space before performing search
-	aDirection = glm::rotate(glm::inverse(transform->Rotation), vector4(aDirection, 0));
+	aDirection = WorldToLocalRotation * aDirection;
 
 	// 'Extents' Method taken from Lattice3D engine - NOTE: causes more false positives AND can cause degenerate simplexes somehow
 	// https://bitbucket.org/Hacktank/lattice3d/src
@@ -53,3 +53,30 @@ glm::vec3 Box::FindFarthestPointInDirection(vector3 aDirection)
 	vector3 result = extentInDirection;
 	return result;
 }
+
+glm::vec3 Box::FindFarthestCorePointInDirection(vector3 aDirection)
+{
+	Transform * transform = pOwner->GetComponent<Transform>();
+	aDirection = WorldToLocalRotation * aDirection;
+
+	// The margin is in world units and the half size gets scaled by the model matrix, eroding a box by a sphere leaves a smaller box
+	vector3 coreHalfSize = glm::max(HalfSize - CollisionMargin / glm::abs(transform->Scale), vector3(0));
+	return vector3(SIGN(aDirection.x) * coreHalfSize.x, SIGN(aDirection.y) * coreHalfSize.y, SIGN(aDirection.z) * coreHalfSize.z);
+}
+
+void Box::UpdateBoundingBox()
+{
+	// Projects the oriented box onto each world axis, the absolute value of the model matrix maps the half size to world extents
+	// Real-Time Collision Detection, 4.2.6 : AABB Recomputed from Rotated AABB
+	vector3 center = vector3(LocalToWorldMatrix[3]);
+	vector3 extents(0);
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			extents[i] += fabs(LocalToWorldMatrix[j][i]) * HalfSize[j];
+		}
+	}
+	BoundingBox.Min = center - extents;
+	BoundingBox.Max = center + extents;
+}
@@ -8,9 +8,13 @@ public:
 	vector3 HalfSize;
 	/*-----------MEMBER FUNCTIONS-----------*/
 public:
+	Box() : 
+		Collider(Collider::BOX) {}
 	virtual void Initialize() override;
 	virtual void Deserialize(TextFileData & aTextData) override {};
 	virtual void Serialize(TextFileData & aTextData) override {};
 
 	virtual vector3 FindFarthestPointInDirection(glm::vec3 aDirection);
+	virtual vector3 FindFarthestCorePointInDirection(glm::vec3 aDirection) override;
+	virtual void UpdateBoundingBox() override;
 };
\ No newline at end of file
@@ -0,0 +1,383 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "BoxBoxCollision.h"
+
+namespace
+{
+	// Face axes are preferred over edge axes, and the faces of A over those of B, unless the other is clearly better
+	// Keeps the reference face from flipping between frames when two axes are nearly tied
+	const float RelativeTolerance = 0.95f;
+	const float AbsoluteTolerance = 0.01f;
+	// Clipping a quad against 4 planes adds at most one point per plane
+	const int MaxClippedPointCount = 8;
+	// Feature IDs of edge-edge contacts start here, above every face contact ID
+	const unsigned int EdgeFeatureBase = 1 << 16;
+
+	// Point of the incident face while it is being clipped
+	// VertexID is the face vertex it started as (0 - 3), or 4 + 8 * clip plane + the polygon edge the plane cut
+	// EdgeID is the polygon edge starting at this point, an incident face edge (0 - 3) or 4 + the clip plane it runs along
+	struct ClipVertex
+	{
+		vector3 Position;
+		unsigned int VertexID;
+		unsigned int EdgeID;
+	};
+
+	// World space frame of a box, the model matrix columns hold the axes scaled by the transform
+	struct OrientedBox
+	{
+		vector3 Center;
+		vector3 Axes[3];
+		vector3 HalfExtents;
+	};
+
+	OrientedBox GetOrientedBox(const Box & aBox)
+	{
+		OrientedBox box;
+		box.Center = vector3(aBox.LocalToWorldMatrix[3]);
+		for (int i = 0; i < 3; ++i)
+		{
+			vector3 column(aBox.LocalToWorldMatrix[i]);
+			float scale = glm::length(column);
+			box.Axes[i] = column / scale;
+			box.HalfExtents[i] = aBox.HalfSize[i] * scale;
+		}
+		return box;
+	}
+
+	// Distance between the projections of the boxes on the axis, negative if they overlap along it
+	inline float GetSeparation(const OrientedBox & aBoxA, const OrientedBox & aBoxB, const vector3 & aAxis, const vector3 & aCenterOffset)
+	{
+		float radiusA = 0.0f, radiusB = 0.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			radiusA += aBoxA.HalfExtents[i] * fabs(glm::dot(aBoxA.Axes[i], aAxis));
+			radiusB += aBoxB.HalfExtents[i] * fabs(glm::dot(aBoxB.Axes[i], aAxis));
+		}
+		return fabs(glm::dot(aCenterOffset, aAxis)) - (radiusA + radiusB);
+	}
+
+	// Sutherland-Hodgman, keeps the part of the convex polygon where dot(aPlaneNormal, p) <= aPlaneOffset
+	int ClipPolygon(const ClipVertex * aInput, int aInputCount, const vector3 & aPlaneNormal, float aPlaneOffset, unsigned int aPlaneIndex, ClipVertex * aOutput)
+	{
+		int outputCount = 0;
+		for (int i = 0; i < aInputCount; ++i)
+		{
+			const ClipVertex & start = aInput[i];
+			const ClipVertex & end = aInput[(i + 1) % aInputCount];
+			float startDistance = glm::dot(aPlaneNormal, start.Position) - aPlaneOffset;
+			float endDistance = glm::dot(aPlaneNormal, end.Position) - aPlaneOffset;
+
+			if (startDistance <= 0.0f)
+				aOutput[outputCount++] = start;
+			if ((startDistance < 0.0f && endDistance > 0.0f) || (startDistance > 0.0f && endDistance < 0.0f))
+			{
+				ClipVertex & intersection = aOutput[outputCount++];
+				intersection.Position = start.Position + (end.Position - start.Position) * (startDistance / (startDistance - endDistance));
+				intersection.VertexID = 4 + 8 * aPlaneIndex + start.EdgeID;
+				// Leaving the kept side the polygon continues along the plane, entering it along the edge that was cut
+				intersection.EdgeID = (startDistance < 0.0f) ? 4 + aPlaneIndex : start.EdgeID;
+			}
+		}
+		return outputCount;
+	}
+
+	// Keeps the deepest point, the point farthest from it, and the two points spanning the largest area on either side of them
+	int ReduceContacts(vector3 * aPoints, float * aDepths, unsigned int * aFeatureIDs, int aCount, const vector3 & aNormal)
+	{
+		int selected[4] = { 0, -1, -1, -1 };
+		for (int i = 1; i < aCount; ++i)
+		{
+			if (aDepths[i] > aDepths[selected[0]])
+				selected[0] = i;
+		}
+
+		float maxDistance = -1.0f;
+		for (int i = 0; i < aCount; ++i)
+		{
+			vector3 offset = aPoints[i] - aPoints[selected[0]];
+			float distance = glm::dot(offset, offset);
+			if (i != selected[0] && distance > maxDistance)
+			{
+				maxDistance = distance;
+				selected[1] = i;
+			}
+		}
+
+		float maxArea = 0.0f, minArea = 0.0f;
+		for (int i = 0; i < aCount; ++i)
+		{
+			if (i == selected[0] || i == selected[1])
+				continue;
+			float area = glm::dot(glm::cross(aPoints[selected[0]] - aPoints[i], aPoints[selected[1]] - aPoints[i]), aNormal);
+			if (area > maxArea)
+			{
+				maxArea = area;
+				selected[2] = i;
+			}
+			if (area < minArea)
+			{
+				minArea = area;
+				selected[3] = i;
+			}
+		}
+
+		vector3 points[4];
+		float depths[4];
+		unsigned int featureIDs[4];
+		int count = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (selected[i] < 0)
+				continue;
+			points[count] = aPoints[selected[i]];
+			depths[count] = aDepths[selected[i]];
+			featureIDs[count] = aFeatureIDs[selected[i]];
+			++count;
+		}
+		for (int i = 0; i < count; ++i)
+		{
+			aPoints[i] = points[i];
+			aDepths[i] = depths[i];
+			aFeatureIDs[i] = featureIDs[i];
+		}
+		return count;
+	}
+
+	// Clips the incident box's face most anti-parallel to aNormal against the reference face, whose outward normal is aNormal
+	// Writes the clipped points below the reference face, which lie on the incident box, returns their count
+	// aReferenceBox is 0 if the reference face is on box A and 1 if it is on box B, it only goes into the feature IDs
+	int GetFaceContacts(const OrientedBox & aReference, const OrientedBox & aIncident, int aReferenceAxis, unsigned int aReferenceBox, const vector3 & aNormal,
+		vector3 * aPoints, float * aDepths, unsigned int * aFeatureIDs)
+	{
+		int incidentAxis = 0;
+		float maxAlignment = -1.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			float alignment = fabs(glm::dot(aNormal, aIncident.Axes[i]));
+			if (alignment > maxAlignment)
+			{
+				maxAlignment = alignment;
+				incidentAxis = i;
+			}
+		}
+		float incidentSign = (glm::dot(aNormal, aIncident.Axes[incidentAxis]) > 0.0f) ? -1.0f : 1.0f;
+		vector3 incidentCenter = aIncident.Center + incidentSign * aIncident.HalfExtents[incidentAxis] * aIncident.Axes[incidentAxis];
+		vector3 incidentU = aIncident.HalfExtents[(incidentAxis + 1) % 3] * aIncident.Axes[(incidentAxis + 1) % 3];
+		vector3 incidentV = aIncident.HalfExtents[(incidentAxis + 2) % 3] * aIncident.Axes[(incidentAxis + 2) % 3];
+
+		ClipVertex polygon[MaxClippedPointCount];
+		ClipVertex clipped[MaxClippedPointCount];
+		polygon[0].Position = incidentCenter + incidentU + incidentV;
+		polygon[1].Position = incidentCenter - incidentU + incidentV;
+		polygon[2].Position = incidentCenter - incidentU - incidentV;
+		polygon[3].Position = incidentCenter + incidentU - incidentV;
+		for (unsigned int i = 0; i < 4; ++i)
+			polygon[i].VertexID = polygon[i].EdgeID = i;
+		int count = 4;
+
+		// Side planes of the reference face
+		for (int i = 1; i < 3 && count > 0; ++i)
+		{
+			const vector3 & sideAxis = aReference.Axes[(aReferenceAxis + i) % 3];
+			float centerOffset = glm::dot(sideAxis, aReference.Center);
+			float halfExtent = aReference.HalfExtents[(aReferenceAxis + i) % 3];
+
+			count = ClipPolygon(polygon, count, sideAxis, centerOffset + halfExtent, 2 * (i - 1), clipped);
+			count = ClipPolygon(clipped, count, -sideAxis, -centerOffset + halfExtent, 2 * (i - 1) + 1, polygon);
+		}
+
+		// Faces are numbered 2 * axis, plus 1 for the one on the negative side
+		unsigned int referenceFace = 2 * aReferenceAxis + ((glm::dot(aNormal, aReference.Axes[aReferenceAxis]) > 0.0f) ? 0 : 1);
+		unsigned int incidentFace = 2 * incidentAxis + ((incidentSign > 0.0f) ? 0 : 1);
+		unsigned int faceFeatureID = (aReferenceBox * 6 + referenceFace) * 6 + incidentFace;
+
+		float referenceOffset = glm::dot(aNormal, aReference.Center) + aReference.HalfExtents[aReferenceAxis];
+		int contactCount = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			float depth = referenceOffset - glm::dot(aNormal, polygon[i].Position);
+			if (depth < 0.0f)
+				continue;
+			aPoints[contactCount] = polygon[i].Position;
+			aDepths[contactCount] = depth;
+			// Vertex IDs stay below 64, 0 is left for points without a feature
+			aFeatureIDs[contactCount] = 1 + 64 * faceFeatureID + polygon[i].VertexID;
+			++contactCount;
+		}
+
+		if (contactCount > 4)
+			contactCount = ReduceContacts(aPoints, aDepths, aFeatureIDs, contactCount, aNormal);
+		return contactCount;
+	}
+
+	// Closest points between the edges of the two boxes parallel to the axes crossed into aNormal
+	void GetEdgeContact(const OrientedBox & aBoxA, const OrientedBox & aBoxB, int aEdgeAxisA, int aEdgeAxisB, const vector3 & aNormal,
+		vector3 & aPointA, vector3 & aPointB, unsigned int & aFeatureID)
+	{
+		// Edge of A farthest along the normal and edge of B farthest against it
+		// Each box has 12 edges, 4 per axis told apart by the sides they are on along the other two axes
+		vector3 edgePointA = aBoxA.Center;
+		vector3 edgePointB = aBoxB.Center;
+		unsigned int edgeA = 4 * aEdgeAxisA, edgeB = 4 * aEdgeAxisB;
+		unsigned int sideBitA = 1, sideBitB = 1;
+		for (int i = 0; i < 3; ++i)
+		{
+			if (i != aEdgeAxisA)
+			{
+				bool bIsPositiveSide = glm::dot(aNormal, aBoxA.Axes[i]) > 0.0f;
+				edgePointA += (bIsPositiveSide ? 1.0f : -1.0f) * aBoxA.HalfExtents[i] * aBoxA.Axes[i];
+				edgeA += bIsPositiveSide ? sideBitA : 0;
+				sideBitA <<= 1;
+			}
+			if (i != aEdgeAxisB)
+			{
+				bool bIsPositiveSide = glm::dot(aNormal, aBoxB.Axes[i]) < 0.0f;
+				edgePointB += (bIsPositiveSide ? 1.0f : -1.0f) * aBoxB.HalfExtents[i] * aBoxB.Axes[i];
+				edgeB += bIsPositiveSide ? sideBitB : 0;
+				sideBitB <<= 1;
+			}
+		}
+		aFeatureID = EdgeFeatureBase + 12 * edgeA + edgeB;
+
+		// Closest points between the two edges, Real-Time Collision Detection 5.1.9, with unit length directions
+		const vector3 & directionA = aBoxA.Axes[aEdgeAxisA];
+		const vector3 & directionB = aBoxB.Axes[aEdgeAxisB];
+		vector3 offset = edgePointA - edgePointB;
+		float b = glm::dot(directionA, directionB);
+		float c = glm::dot(directionA, offset);
+		float f = glm::dot(directionB, offset);
+		float denominator = 1.0f - b * b;
+		float s = (denominator > 1e-6f) ? (b * f - c) / denominator : 0.0f;
+		s = glm::clamp(s, -aBoxA.HalfExtents[aEdgeAxisA], aBoxA.HalfExtents[aEdgeAxisA]);
+		float t = glm::clamp(b * s + f, -aBoxB.HalfExtents[aEdgeAxisB], aBoxB.HalfExtents[aEdgeAxisB]);
+
+		aPointA = edgePointA + s * directionA;
+		aPointB = edgePointB + t * directionB;
+	}
+
+	inline void SetContact(ContactData & aContact, const matrix4 & aWorldToLocalA, const matrix4 & aWorldToLocalB, const vector3 & aPointA, const vector3 & aPointB,
+		const vector3 & aNormal, float aDepth, unsigned int aFeatureID)
+	{
+		aContact.ContactPositionA_WS = aPointA;
+		aContact.ContactPositionB_WS = aPointB;
+		aContact.ContactPositionA_LS = vector3(aWorldToLocalA * vector4(aPointA, 1));
+		aContact.ContactPositionB_LS = vector3(aWorldToLocalB * vector4(aPointB, 1));
+		aContact.Normal = aNormal;
+		aContact.PenetrationDepth = aDepth;
+		aContact.FeatureID = aFeatureID;
+		aContact.Lifetime = 0;
+	}
+}
+
+bool BoxBoxCollision::Collide(Box & aBoxA, Box & aBoxB, ContactManifold & aManifold)
+{
+	aManifold.Clear();
+
+	OrientedBox boxA = GetOrientedBox(aBoxA);
+	OrientedBox boxB = GetOrientedBox(aBoxB);
+	vector3 centerOffset = boxB.Center - boxA.Center;
+
+	// Face axes of A, then of B, stopping at the first one that separates the boxes
+	float faceSeparationA = -FLT_MAX, faceSeparationB = -FLT_MAX;
+	int faceAxisA = 0, faceAxisB = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		float separation = GetSeparation(boxA, boxB, boxA.Axes[i], centerOffset);
+		if (separation > 0.0f)
+			return false;
+		if (separation > faceSeparationA)
+		{
+			faceSeparationA = separation;
+			faceAxisA = i;
+		}
+	}
+	for (int i = 0; i < 3; ++i)
+	{
+		float separation = GetSeparation(boxA, boxB, boxB.Axes[i], centerOffset);
+		if (separation > 0.0f)
+			return false;
+		if (separation > faceSeparationB)
+		{
+			faceSeparationB = separation;
+			faceAxisB = i;
+		}
+	}
+
+	// Edge axes, skipping the parallel edge pairs since a face axis already covers them
+	float edgeSeparation = -FLT_MAX;
+	int edgeAxisA = -1, edgeAxisB = -1;
+	vector3 edgeAxis;
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			vector3 axis = glm::cross(boxA.Axes[i], boxB.Axes[j]);
+			float length = glm::length(axis);
+			if (length < 1e-5f)
+				continue;
+			axis /= length;
+
+			float separation = GetSeparation(boxA, boxB, axis, centerOffset);
+			if (separation > 0.0f)
+				return false;
+			if (separation > edgeSeparation)
+			{
+				edgeSeparation = separation;
+				edgeAxisA = i;
+				edgeAxisB = j;
+				edgeAxis = axis;
+			}
+		}
+	}
+
+	matrix4 worldToLocalA = glm::inverse(aBoxA.LocalToWorldMatrix);
+	matrix4 worldToLocalB = glm::inverse(aBoxB.LocalToWorldMatrix);
+
+	float faceSeparation = std::max(faceSeparationA, faceSeparationB);
+	if (edgeAxisA >= 0 && RelativeTolerance * edgeSeparation > faceSeparation + AbsoluteTolerance)
+	{
+		vector3 normal = (glm::dot(centerOffset, edgeAxis) < 0.0f) ? -edgeAxis : edgeAxis;
+		vector3 pointA, pointB;
+		unsigned int featureID;
+		GetEdgeContact(boxA, boxB, edgeAxisA, edgeAxisB, normal, pointA, pointB, featureID);
+		SetContact(aManifold.ManifoldPoints[0], worldToLocalA, worldToLocalB, pointA, pointB, normal, -edgeSeparation, featureID);
+		aManifold.Size = 1;
+		return true;
+	}
+
+	vector3 points[MaxClippedPointCount];
+	float depths[MaxClippedPointCount];
+	unsigned int featureIDs[MaxClippedPointCount];
+	int contactCount = 0;
+	if (RelativeTolerance * faceSeparationB > faceSeparationA + AbsoluteTolerance)
+	{
+		// Reference face on B, the clipped points lie on A
+		vector3 normal = (glm::dot(centerOffset, boxB.Axes[faceAxisB]) < 0.0f) ? -boxB.Axes[faceAxisB] : boxB.Axes[faceAxisB];
+		contactCount = GetFaceContacts(boxB, boxA, faceAxisB, 1, -normal, points, depths, featureIDs);
+		for (int i = 0; i < contactCount; ++i)
+			SetContact(aManifold.ManifoldPoints[i], worldToLocalA, worldToLocalB, points[i], points[i] - depths[i] * normal, normal, depths[i], featureIDs[i]);
+	}
+	else
+	{
+		// Reference face on A, the clipped points lie on B
+		vector3 normal = (glm::dot(centerOffset, boxA.Axes[faceAxisA]) < 0.0f) ? -boxA.Axes[faceAxisA] : boxA.Axes[faceAxisA];
+		contactCount = GetFaceContacts(boxA, boxB, faceAxisA, 0, normal, points, depths, featureIDs);
+		for (int i = 0; i < contactCount; ++i)
+			SetContact(aManifold.ManifoldPoints[i], worldToLocalA, worldToLocalB, points[i] + depths[i] * normal, points[i], normal, depths[i], featureIDs[i]);
+	}
+	aManifold.Size = contactCount;
+
+	// A preferred face axis can leave nothing below the reference face when the edges are actually the ones touching
+	if (contactCount == 0 && edgeAxisA >= 0)
+	{
+		vector3 normal = (glm::dot(centerOffset, edgeAxis) < 0.0f) ? -edgeAxis : edgeAxis;
+		vector3 pointA, pointB;
+		unsigned int featureID;
+		GetEdgeContact(boxA, boxB, edgeAxisA, edgeAxisB, normal, pointA, pointB, featureID);
+		SetContact(aManifold.ManifoldPoints[0], worldToLocalA, worldToLocalB, pointA, pointB, normal, -edgeSeparation, featureID);
+		aManifold.Size = 1;
+	}
+	return aManifold.Size > 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "PhysicsUtilities.h"
+#include "NarrowphaseDispatch.h"
+#include "Box.h"
+
+// Separating axis test between two oriented boxes, with contact generation by face clipping
+// Real-Time Collision Detection, 4.4.1 : OBB-OBB Intersection, for the 15 axes
+// Dirk Gregorius - The Separating Axis Test between Convex Polyhedra (GDC 2013), for the contact generation
+// When the axis of least penetration is a face normal, the most anti-parallel face of the other box is clipped against
+// the side planes of that face (Sutherland-Hodgman) and every clipped point below it becomes a contact, keeping the best 4.
+// When it is an edge-edge axis, the closest points between the two edges give a single contact.
+namespace BoxBoxCollision
+{
+	// Replaces the contents of aManifold and returns true if the boxes overlap, model matrices must be up to date
+	// Contact normals point from aBoxA to aBoxB, like the ones from EPA
+	bool Collide(Box & aBoxA, Box & aBoxB, ContactManifold & aManifold);
+}
+
+namespace NarrowphaseDispatch
+{
+	template <>
+	struct PairKernel<Collider::BOX, Collider::BOX>
+	{
+		static const bool bIsDefined = true;
+		static inline bool Collide(Collider & aColliderA, Collider & aColliderB, ContactManifold & aManifold)
+		{
+			return BoxBoxCollision::Collide(static_cast<Box &>(aColliderA), static_cast<Box &>(aColliderB), aManifold);
+		}
+	};
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include "PhysicsUtilities.h"
+
+class Collider;
+
+// Abstract base class for any structure that culls collider pairs before they reach the narrowphase (GJK)
+// Proxies are keyed by Collider::ColliderSlot
+class Broadphase
+{
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	virtual ~Broadphase() {}
+
+	virtual void AddCollider(Collider * aCollider) = 0;
+	virtual void RemoveCollider(Collider * aCollider) = 0;
+	// Refreshes every proxy from the current Collider::BoundingBox
+	virtual void Update() = 0;
+	// Appends every pair of colliders whose bounds overlap to the pair list
+	virtual void FindOverlappingPairs(std::vector<ColliderPair> & aPairList) = 0;
+
+protected:
+	// Packs two proxy IDs into a single key, lower ID in the high bits so the key doesn't depend on argument order
+	static inline unsigned long long GetPairKey(int aProxyA, int aProxyB)
+	{
+		if (aProxyA > aProxyB)
+			std::swap(aProxyA, aProxyB);
+		return ((unsigned long long)aProxyA << 32) | (unsigned int)aProxyB;
+	}
+	static inline int GetFirstProxyID(unsigned long long aPairKey) { return (int)(aPairKey >> 32); }
+	static inline int GetSecondProxyID(unsigned long long aPairKey) { return (int)(aPairKey & 0xffffffff); }
+};
@@ -0,0 +1,62 @@
+#include "Typedefs.h"
+#include "Capsule.h"
+#include "GameObject.h"
+#include "Transform.h"
+#include "MathUtilities.h"
+
+void Capsule::Initialize()
+{
+	// The support function is analytic, so unlike Box no collider mesh is imported
+	Transform & transform = *pOwner->GetComponent<Transform>();
+	vector3 scale = glm::abs(transform.Scale);
+	float radius = Radius * glm::max(scale.x, scale.z);
+	float height = 2.0f * HalfHeight * scale.y;
+
+	// The whole capsule is margin around its segment, so any penetration shallower than the radius gets its normal without EPA
+	CollisionMargin = radius;
+
+	// Inertia tensor in body space of a cylinder capped by two hemispheres, with the mass split between them by volume
+	// The hemispheres are moved to the ends of the cylinder with the parallel axis theorem, from their own center of mass 3r/8 off the flat side
+	// Volumes are pi r^2 h and 4/3 pi r^3, pi r^2 cancels out of the ratio
+	float cylinderMass = height / (height + (4.0f / 3.0f) * radius);
+	float sphereMass = 1.0f - cylinderMass;
+
+	float axial = cylinderMass * (0.5f * radius * radius) + sphereMass * (0.4f * radius * radius);
+	float transverse = cylinderMass * (0.25f * radius * radius + height * height / 12.0f) +
+		sphereMass * (0.4f * radius * radius + 0.25f * height * height + 0.375f * height * radius);
+
+	InertiaTensor = glm::mat3(0);
+	InertiaTensor[0][0] = transverse;
+	InertiaTensor[1][1] = axial;
+	InertiaTensor[2][2] = transverse;
+}
+
+glm::vec3 Capsule::FindFarthestPointInDirection(vector3 aDirection)
+{
+	// Farthest end of the segment plus the support of the sphere, which is an ellipsoid in local space as for Sphere
+	vector3 scale(glm::length(vector3(LocalToWorldMatrix[0])), glm::length(vector3(LocalToWorldMatrix[1])), glm::length(vector3(LocalToWorldMatrix[2])));
+	vector3 localDirection(glm::dot(vector3(LocalToWorldMatrix[0]), aDirection) / scale.x,
+						   glm::dot(vector3(LocalToWorldMatrix[1]), aDirection) / scale.y,
+						   glm::dot(vector3(LocalToWorldMatrix[2]), aDirection) / scale.z);
+	vector3 result(0.0f, SIGN(localDirection.y) * HalfHeight, 0.0f);
+	float length = glm::length(localDirection);
+	if (length == 0.0f)
+		return result;
+
+	float worldRadius = Radius * glm::max(scale.x, scale.z);
+	return result + (worldRadius / length) * localDirection / scale;
+}
+
+glm::vec3 Capsule::FindFarthestCorePointInDirection(vector3 aDirection)
+{
+	return vector3(0.0f, SIGN(glm::dot(vector3(LocalToWorldMatrix[1]), aDirection)) * HalfHeight, 0.0f);
+}
+
+void Capsule::UpdateBoundingBox()
+{
+	vector3 start, end;
+	GetWorldSegment(start, end);
+	vector3 extents(GetWorldRadius());
+	BoundingBox.Min = glm::min(start, end) - extents;
+	BoundingBox.Max = glm::max(start, end) + extents;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "Collider.h"
+// Segment along the local Y axis swept by a sphere
+class Capsule : public Collider
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	// Local space, scaled by the largest of the X and Z components of the transform scale
+	float Radius = 0.5f;
+	// Half the length of the segment, scaled by the Y component of the transform scale
+	float HalfHeight = 0.5f;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	Capsule() :
+		Collider(Collider::CAPSULE) {}
+	virtual void Initialize() override;
+	virtual void Deserialize(TextFileData & aTextData) override {};
+	virtual void Serialize(TextFileData & aTextData) override {};
+
+	virtual vector3 FindFarthestPointInDirection(glm::vec3 aDirection);
+	virtual vector3 FindFarthestCorePointInDirection(glm::vec3 aDirection) override;
+	virtual void UpdateBoundingBox() override;
+
+	// Model matrix must be up to date
+	inline void GetWorldSegment(vector3 & aStart, vector3 & aEnd) const
+	{
+		vector3 center(LocalToWorldMatrix[3]);
+		vector3 halfSegment = HalfHeight * vector3(LocalToWorldMatrix[1]);
+		aStart = center - halfSegment;
+		aEnd = center + halfSegment;
+	}
+	inline float GetWorldRadius() const
+	{
+		return Radius * glm::max(glm::length(vector3(LocalToWorldMatrix[0])), glm::length(vector3(LocalToWorldMatrix[2])));
+	}
+};
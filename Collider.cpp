@@ -0,0 +1,10 @@
+#include "Collider.h"
+#include "GameObject.h"
+#include "Engine.h"
+#include "PhysicsManager.h"
+
+void Collider::Destroy()
+{
+	// The broadphases, pair cache and constraints must not keep referring to a collider that is going away
+	pOwner->EngineHandle.GetPhysicsManager().UnregisterColliderObject(this);
+}
@@ -4,6 +4,8 @@
 
 #include "Component.h"
 #include "DebugVertex.h"
+#include "PhysicsUtilities.h"
+#include "SIMDUtilities.h"
 
 // Abstract base class for any component that implements a collision shape (box, capsule, sphere, etc) 
 class Collider : public Component
@@ -17,31 +19,83 @@ public:
 		KINEMATIC,
 		ColliderTypeCount
 	};
+	// Concrete shape, used to pick the narrowphase routine for a pair
+	enum ShapeType
+	{
+		BOX,
+		SPHERE,
+		CAPSULE,
+		CONVEX_HULL,
+		ShapeTypeCount
+	};
 	bool bIsCollisionEnabled;
 	bool bShouldRenderDebug;
 	std::vector<DebugVertex> Vertices;
 	// index in ColliderObjectsList
 	int ColliderSlot = 0;
 	ColliderType eColliderType = ColliderType::DYNAMIC;
-	// Jacobians per constraint type
-	Eigen::Matrix<float, 1, 6> ContactJacobian;
+	const ShapeType eShapeType;
 	// Rotational Inertia Tensor
 	glm::mat3 InertiaTensor = glm::mat3(1);
-	// Contains inverted mass and inertia tensors
-	Eigen::Matrix<float, 6, 6> InverseMassMatrix;
 	// Coefficient of restitution, a value between 0 and 1
 	float Restitution = 1.0f;
+	// Coefficient of friction, combined with the other collider's as their geometric mean
+	float Friction = 0.5f;
 	glm::mat4 LocalToWorldMatrix;
+	// Transpose of the rotation part of LocalToWorldMatrix, refreshed with it so support functions don't invert the rotation per call
+	matrix3 WorldToLocalRotation = matrix3(1);
+	// World space bounds, refreshed from LocalToWorldMatrix once per frame before the broadphase runs
+	AABB BoundingBox;
+	// World space distance the shape is shrunk by to get its core, the closest points between cores give the normal
+	// of penetrations shallower than the margins without EPA. Zero for shapes that don't provide a core support function
+	float CollisionMargin = 0.0f;
 	/*-----------MEMBER FUNCTIONS-----------*/
 public:
-	Collider() : 
-		Component(Component::COLLIDER) {}
+	Collider(ShapeType aShapeType) : 
+		Component(Component::COLLIDER),
+		eShapeType(aShapeType) {}
 	~Collider() {}
 
 	static inline ComponentType GetComponentID() { return Component::ComponentType::COLLIDER; }
 
 	virtual glm::vec3 FindFarthestPointInDirection(glm::vec3 aDirection) = 0;
+	// Support point of the shape shrunk by CollisionMargin, in local space like FindFarthestPointInDirection
+	virtual glm::vec3 FindFarthestCorePointInDirection(glm::vec3 aDirection) { return FindFarthestPointInDirection(aDirection); }
+	// Batched FindFarthestPointInDirection, the first aCount lanes of aDirections are world space directions and the local space
+	// support points are written to the same lanes of aLocalPoints.
+	// Lanes past aCount up to the next multiple of 4 hold finite values on input and must be left holding finite values,
+	// SIMD code computes them along with the others
+	// Generic version calls the single direction support for each lane, shapes that can use SIMD should override it
+	virtual void FindFarthestPointsInDirections(const Vector3Batch & aDirections, int aCount, Vector3Batch & aLocalPoints)
+	{
+		for (int i = 0; i < ((aCount + 3) & ~3); ++i)
+			aLocalPoints.Set(i, (i < aCount) ? FindFarthestPointInDirection(aDirections.Get(i)) : glm::vec3(0));
+	}
+	// Generic version uses the support function along each world axis, shapes with a cheaper closed form should override it
+	virtual void UpdateBoundingBox()
+	{
+		// All six directions go through a single batch
+		Vector3Batch directions, localPoints, worldPoints;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			glm::vec3 direction(0);
+			direction[axis] = 1.0f;
+			directions.Set(2 * axis, direction);
+			directions.Set(2 * axis + 1, -direction);
+		}
+		directions.Set(6, glm::vec3(0));
+		directions.Set(7, glm::vec3(0));
+		FindFarthestPointsInDirections(directions, 6, localPoints);
+		SIMD::Transform(matrix3(LocalToWorldMatrix), vector3(LocalToWorldMatrix[3]), localPoints, worldPoints);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			BoundingBox.Max[axis] = worldPoints.Get(2 * axis)[axis];
+			BoundingBox.Min[axis] = worldPoints.Get(2 * axis + 1)[axis];
+		}
+	}
 	virtual void Update() {};
+	// Unregisters the collider from the physics manager
+	virtual void Destroy() override;
 	virtual void Deserialize(TextFileData aTextData) {};
 
 };
\ No newline at end of file
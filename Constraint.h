@@ -1,10 +1,9 @@
 ﻿#pragma once
-// Eigen arbitrary size dense matrix header
-#include <Eigen/Dense>
-#include <vector>
+#include "SolverData.h"
 
 // Abstract base class for any type of constraint
 // A constraint is used to affect/limit an objects degree of freedom(s)
+// The solver works on the compact rows the constraints fill in their prestep, the constraints only keep what lasts between steps
 class Collider;
 class Constraint
 {
@@ -13,38 +12,32 @@ public:
 	Collider * ColliderA;
 	Collider * ColliderB;
 
-	// The constraint Jacobian is a 12-by-1 row vector
-	Eigen::Matrix<float, 1, 12> Jacobian;
-	// B = M^-1 * J^T (M inverse * J transpose)
-	Eigen::Matrix<float, 12, 1> Catto_B;
-	// M^-1 matrix (M inverse)
-	Eigen::Matrix<float, 12, 12> InverseMassMatrix;
-
-	// Lagrangian multiplier/ magnitude of impulse to resolve the constraint, in constraint space
-	float ImpulseMagnitude = 0.0f;
-	// 'Initial Guess' at ImpulseMagnitude
-	static float InitialLambda;
-	// η (or) 'Eta' value, updated every iteration of the solver
-	float Catto_Eta = 0.0f;
-	// ∆λi value, updated every iteration of the solver
-	float DeltaLambda = 0.0f;
 	// index in ConstraintObjectsList
 	int ConstraintSlot = 0;
-	// 'Effective' mass of constraint system
-	float EffectiveMass = 0.0f;
+	// Constraints whose impulse stops changing are removed by the solver, unless something else owns them like a contact manifold
+	bool bIsDiscardable = true;
 	/*-----------MEMBER FUNCTIONS-----------*/
 public:
 	Constraint(Collider & aColliderA, Collider & aColliderB) :
 		ColliderA(&aColliderA),
 		ColliderB(&aColliderB) 
-	{
-		// Calculate the Inverse Mass Matrix when created
-		CalculateInverseMassMatrices();
-	}
-	// All constraints must implement how the solver will handle them
-	virtual float Solve(float aTimestep, std::vector<Eigen::Matrix<float, 6, 1>> & aCatto_A, Eigen::Matrix<float, 12, 1> & aCurrentVelocityVector, Eigen::Matrix<float, 12, 1> & aExternalForceVector) = 0;
+	{}
+	virtual ~Constraint() {}
 	// All constraints have different components for their Jacobians, hence calculation is left up to child class
-	virtual void CalculateJacobian() = 0;
+	virtual void CalculateJacobian(ConstraintRow & aRow) = 0;
+	// Runs once per step before the solver iterations, fills the row with everything that stays the same across them
+	// BodyA and BodyB of the row must already be set, the impulse sum is left at the one accumulated last step for warm starting
+	virtual void PreStep(float aTimestep, const SolverBodyList & aBodies, ConstraintRow & aRow);
+	// Keeps what the solver found for the next step
+	virtual void PostStep(const ConstraintRow & aRow) = 0;
+	// Fills the ConstraintRow::FrictionRowCount rows of aFrictionRows after the prestep of aRow, false if the constraint has no friction
+	// The limits are left to the solver, they follow the impulse of aRow
+	virtual bool PreStepFriction(const SolverBodyList &, const ConstraintRow &, ConstraintRow *) { return false; }
+	virtual void PostStepFriction(const ConstraintRow *) {}
+	// Constraints returning the same ID are solved together by the block solver, -1 for those solved alone
+	virtual int GetBlockID() const { return -1; }
 
-	void CalculateInverseMassMatrices();
+protected:
+	// B = M^-1 * J^T, effective mass and external force term of a row whose Jacobian and bodies are set
+	static void PreStepJacobian(const SolverBodyList & aBodies, ConstraintRow & aRow);
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include "ConstraintGraphColoring.h"
+
+void ConstraintGraphColoring::Build(const std::vector<ConstraintRow> & aRows, const std::vector<int> & aRowIndices, int aBodyCount)
+{
+	int rowCount = (int)aRowIndices.size();
+	BodyColorMaskList.assign(aBodyCount, 0);
+	RowColorList.resize(rowCount);
+
+	// Rows counted per color, MaxColorCount is the overflow batch
+	int colorSizes[MaxColorCount + 1] = {};
+	int colorCount = 0;
+	for (int i = 0; i < rowCount; ++i)
+	{
+		const ConstraintRow & row = aRows[aRowIndices[i]];
+		unsigned long long usedMask = 0;
+		if (row.BodyA != SolverBodyList::StaticBody)
+			usedMask |= BodyColorMaskList[row.BodyA];
+		if (row.BodyB != SolverBodyList::StaticBody)
+			usedMask |= BodyColorMaskList[row.BodyB];
+
+		int color = MaxColorCount;
+		if (usedMask != ~0ull)
+		{
+			// Lowest clear bit
+			unsigned long long freeBit = ~usedMask & (usedMask + 1);
+			color = 0;
+			while ((freeBit >> color) != 1)
+				++color;
+			if (row.BodyA != SolverBodyList::StaticBody)
+				BodyColorMaskList[row.BodyA] |= freeBit;
+			if (row.BodyB != SolverBodyList::StaticBody)
+				BodyColorMaskList[row.BodyB] |= freeBit;
+			colorCount = std::max(colorCount, color + 1);
+		}
+		RowColorList[i] = color;
+		++colorSizes[color];
+	}
+
+	// Colors are laid out one after the other, keeping the row order inside each so the result only depends on the rows
+	bHasOverflow = colorSizes[MaxColorCount] > 0;
+	if (bHasOverflow)
+	{
+		colorSizes[colorCount] = colorSizes[MaxColorCount];
+		for (int i = 0; i < rowCount; ++i)
+		{
+			if (RowColorList[i] == MaxColorCount)
+				RowColorList[i] = colorCount;
+		}
+		++colorCount;
+	}
+
+	ColorStartList.resize(colorCount + 1);
+	ColorStartList[0] = 0;
+	for (int color = 0; color < colorCount; ++color)
+		ColorStartList[color + 1] = ColorStartList[color] + colorSizes[color];
+
+	RowList.resize(rowCount);
+	std::vector<int> nextRowList(ColorStartList.begin(), ColorStartList.end() - 1);
+	for (int i = 0; i < rowCount; ++i)
+		RowList[nextRowList[RowColorList[i]]++] = aRowIndices[i];
+}
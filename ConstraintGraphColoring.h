@@ -0,0 +1,38 @@
+#pragma once
+#include <vector>
+#include "SolverData.h"
+
+// Splits the rows of an island into colors, no two rows of a color share a dynamic body
+// The rows of a color can then be solved in any order and on any number of threads with the same result,
+// the static body is never written to by the solver so it doesn't count as shared.
+// Greedy coloring in row order, each row takes the lowest color neither of its bodies has used yet.
+class ConstraintGraphColoring
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	// Bodies keep the colors they used in a 64 bit mask, rows that can't get one go to a last batch solved by a single thread
+	static const int MaxColorCount = 64;
+private:
+	// Indices of the rows grouped by color, the overflow batch last
+	std::vector<int> RowList;
+	// Start of each color in RowList, plus the end of the last one
+	std::vector<int> ColorStartList;
+	bool bHasOverflow = false;
+	// Indexed by solver body, colors already used by its rows
+	std::vector<unsigned long long> BodyColorMaskList;
+	// Color of each row, in the order of the row indices
+	std::vector<int> RowColorList;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	// Colors the rows of aRows listed in aRowIndices, the body indices of the rows must be set
+	void Build(const std::vector<ConstraintRow> & aRows, const std::vector<int> & aRowIndices, int aBodyCount);
+
+	// Includes the overflow batch if there is one
+	inline int GetColorCount() const { return (int)ColorStartList.size() - 1; }
+	inline int GetColorBegin(int aColor) const { return ColorStartList[aColor]; }
+	inline int GetColorEnd(int aColor) const { return ColorStartList[aColor + 1]; }
+	// Index in the row list of the aIndex-th colored row
+	inline int GetRow(int aIndex) const { return RowList[aIndex]; }
+	// The overflow batch may share bodies between its rows and must be solved in order by a single thread
+	inline bool IsSerialColor(int aColor) const { return bHasOverflow && aColor == GetColorCount() - 1; }
+};
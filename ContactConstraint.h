@@ -1,6 +1,4 @@
 ﻿#pragma once
-#include <Eigen/Dense>
-
 #include "Constraint.h"
 #include "PhysicsUtilities.h"
 
@@ -11,9 +9,9 @@ class ContactConstraint : public Constraint
 	/*-----------MEMBER VARIABLES-----------*/
 public:
 	ContactData ConstraintData;
-	// Slot of the manifold used to contain all contacts related to this constraint
-	int ManifoldID = 0;
-	// Used for clamping
+	// Slot of the manifold used to contain all contacts related to this constraint, -1 if it isn't part of one
+	int ManifoldID = -1;
+	// Used for clamping, kept from the row of the last step
 	float NormalImpulseSum = 0.0f;
 	float TangentImpulseSum1 = 0.0f;
 	float TangentImpulseSum2 = 0.0f;
@@ -21,7 +19,20 @@ public:
 public:
 	ContactConstraint(Collider & aColliderA, Collider & aColliderB) : Constraint(aColliderA, aColliderB)
 	{}
-	virtual void CalculateJacobian() override;
-	virtual float Solve(float aTimestep, std::vector<Eigen::Matrix<float, 6, 1>> & aCatto_A, Eigen::Matrix<float, 12, 1> & aCurrentVelocityVector, Eigen::Matrix<float, 12, 1> & aExternalForceVector) override; 
+	virtual void CalculateJacobian(ConstraintRow & aRow) override;
+	virtual void PreStep(float aTimestep, const SolverBodyList & aBodies, ConstraintRow & aRow) override;
+	virtual void PostStep(const ConstraintRow & aRow) override;
+	// Friction rows along the two tangents of the point, warm started from the tangent impulses
+	virtual bool PreStepFriction(const SolverBodyList & aBodies, const ConstraintRow & aRow, ConstraintRow * aFrictionRows) override;
+	virtual void PostStepFriction(const ConstraintRow * aFrictionRows) override;
+	// Friction rows along the tangents of this point but at the anchor, a point shared by the whole manifold, warm started from the given impulses
+	// The constraint keeps the impulses of the anchor as its tangent impulses
+	bool PreStepFrictionAnchor(const SolverBodyList & aBodies, const vector3 & aAnchorA, const vector3 & aAnchorB, float aTangentImpulseSum1, float aTangentImpulseSum2,
+		const ConstraintRow & aRow, ConstraintRow * aFrictionRows);
+	// The points of a manifold make up one block
+	virtual int GetBlockID() const override { return ManifoldID; }
+private:
+	// Jacobian of the relative velocity along aDirection between the point aPointA on A and aPointB on B
+	void SetJacobian(ConstraintRow & aRow, const vector3 & aPointA, const vector3 & aPointB, const vector3 & aDirection) const;
 
 };
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include <iostream>
+#include "Typedefs.h"
+#include "ConvexHull.h"
+#include "ResourceManager.h"
+#include "GameObject.h"
+#include "Transform.h"
+#include "Engine.h"
+
+void ConvexHull::Initialize()
+{
+	// Loads the mesh vertex positions/color data from file, only their positions are kept in the hull
+	Vertices = std::move(pOwner->EngineHandle.GetResourceManager().ImportColliderData(ModelName));
+	std::vector<vector3> points;
+	points.reserve(Vertices.size());
+	for (const DebugVertex & vertex : Vertices)
+		points.push_back(vertex.Position);
+	if (QuickHull::Build(points, Hull) == false)
+	{
+		std::cout << "Could not build a convex hull from " << ModelName << "\n";
+		return;
+	}
+	LastSupportVertex = 0;
+
+	// Inertia tensor of the solid hull with unit mass, integrated over the tetrahedra joining the origin to each face
+	// It stays about the mesh origin rather than the centroid, the solver and the integration rotate the body about its transform's position
+	// Each tetrahedron with edges a, b, c from the origin contributes det(a, b, c) / 120 * (aa' + bb' + cc' + (a + b + c)(a + b + c)')
+	// to the covariance, Real-Time Collision Detection 4.3.4 / Jonathan Blow, Atman Binstock - How to find the inertia tensor (2004)
+	Transform & transform = *pOwner->GetComponent<Transform>();
+	float covariance[3][3] = { { 0.0f } };
+	float volume = 0.0f;
+	for (int face = 0; face < Hull.GetFaceCount(); ++face)
+	{
+		vector3 a = Hull.VertexList[Hull.EdgeList[3 * face].Origin] * transform.Scale;
+		vector3 b = Hull.VertexList[Hull.EdgeList[3 * face + 1].Origin] * transform.Scale;
+		vector3 c = Hull.VertexList[Hull.EdgeList[3 * face + 2].Origin] * transform.Scale;
+		float determinant = glm::dot(a, glm::cross(b, c));
+		const vector3 terms[4] = { a, b, c, a + b + c };
+		for (const vector3 & term : terms)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				for (int j = 0; j < 3; ++j)
+					covariance[i][j] += (determinant / 120.0f) * term[i] * term[j];
+			}
+		}
+		volume += determinant / 6.0f;
+	}
+	if (volume <= 0.0f)
+		return;
+
+	// I = trace(C) * Identity - C
+	float trace = (covariance[0][0] + covariance[1][1] + covariance[2][2]) / volume;
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+			InertiaTensor[i][j] = ((i == j) ? trace : 0.0f) - covariance[i][j] / volume;
+	}
+}
+
+glm::vec3 ConvexHull::FindFarthestPointInDirection(vector3 aDirection)
+{
+	if (Hull.VertexList.empty())
+		return vector3(0);
+
+	// dot(M * p, d) = dot(p, M' * d), so the rotation and scale are both taken into account
+	vector3 localDirection(glm::dot(vector3(LocalToWorldMatrix[0]), aDirection),
+						   glm::dot(vector3(LocalToWorldMatrix[1]), aDirection),
+						   glm::dot(vector3(LocalToWorldMatrix[2]), aDirection));
+
+	// Move to the neighbor farthest along the direction until none of them is farther
+	int vertex = LastSupportVertex;
+	float maxProjection = glm::dot(Hull.VertexList[vertex], localDirection);
+	bool bHasMoved = true;
+	while (bHasMoved)
+	{
+		bHasMoved = false;
+		int firstEdge = Hull.VertexEdgeList[vertex];
+		int edge = firstEdge;
+		do
+		{
+			int neighbor = Hull.EdgeList[Hull.EdgeList[edge].Next].Origin;
+			float projection = glm::dot(Hull.VertexList[neighbor], localDirection);
+			if (projection > maxProjection)
+			{
+				maxProjection = projection;
+				vertex = neighbor;
+				bHasMoved = true;
+			}
+			// Next edge leaving the same vertex
+			edge = Hull.EdgeList[Hull.EdgeList[edge].Twin].Next;
+		} while (edge != firstEdge);
+	}
+	LastSupportVertex = vertex;
+	return Hull.VertexList[vertex];
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include "Collider.h"
+#include "QuickHull.h"
+
+// Convex hull of the vertices of an imported mesh
+class ConvexHull : public Collider
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	// Mesh whose vertices are imported and wrapped at Initialize
+	std::string ModelName = std::string("Cube.fbx");
+	HalfEdgeMesh Hull;
+	// Vertex the last support query ended on, the next query climbs from there
+	int LastSupportVertex = 0;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	ConvexHull() :
+		Collider(Collider::CONVEX_HULL) {}
+	virtual void Initialize() override;
+	virtual void Deserialize(TextFileData & aTextData) override {};
+	virtual void Serialize(TextFileData & aTextData) override {};
+
+	// Hill climbs along the edges of the hull, which only has a single local maximum in any direction
+	// Support queries in directions close to the previous one only take a few steps
+	virtual vector3 FindFarthestPointInDirection(glm::vec3 aDirection);
+};
@@ -42,6 +42,92 @@ bool DebugSettingsWidget::DrawWidget()
 		ImGui::SliderInt("Integrator Iterations: ", &PhysicsManager::IntegratorIterations, 1, 100);
 		ImGui::PopItemWidth();
 
+		ImGui::PushItemWidth(150);
+		ImGui::Combo("Broadphase ", (int *)&physicsManager.eBroadphaseMode, PhysicsManager::BroadphaseModeName, PhysicsManager::BroadphaseModeCount);
+		ImGui::PopItemWidth();
+
+		if (physicsManager.eBroadphaseMode == PhysicsManager::SPATIAL_HASH_GRID)
+		{
+			ImGui::PushItemWidth(150);
+			ImGui::SliderFloat("Grid Cell Size ", &physicsManager.HashGridBroadphase.CellSize, 0.25f, 20.0f);
+			ImGui::PopItemWidth();
+			ImGui::Checkbox("Multithreaded Grid Build ", &physicsManager.HashGridBroadphase.bIsMultithreaded);
+			ImGui::Text("%d cells occupied, %d oversized colliders, %d threads", physicsManager.HashGridBroadphase.GetOccupiedCellCount(),
+				physicsManager.HashGridBroadphase.GetOversizedProxyCount(), physicsManager.HashGridBroadphase.GetThreadCount());
+		}
+
+		// Last recorded frame of each mode, switch between modes to compare them
+		for (int i = 0; i < PhysicsManager::BroadphaseModeCount; ++i)
+		{
+			PhysicsManager::BroadphaseStatistics & stats = physicsManager.BroadphaseStats[i];
+			ImGui::Text("%s : %d pairs tested, %d colliding, broadphase %.3f ms, narrowphase %.3f ms", PhysicsManager::BroadphaseModeName[i],
+				stats.CandidatePairCount, stats.CollidingPairCount, stats.BroadphaseTime, stats.NarrowphaseTime);
+		}
+		ImGui::Text("Static BVH : %d colliders, %d nodes, depth %d", physicsManager.StaticGeometry.GetPrimitiveCount(),
+			physicsManager.StaticGeometry.GetNodeCount(), physicsManager.StaticGeometry.GetDepth());
+		ImGui::Text("Pair cache : %d pairs, %d evicted last step", physicsManager.CollisionPairCache.GetPairCount(),
+			physicsManager.CollisionPairCache.GetEvictedPairCount());
+
+		ImGui::PushItemWidth(150);
+		ImGui::Combo("Narrowphase ", (int *)&physicsManager.eNarrowphaseMode, PhysicsManager::NarrowphaseModeName, PhysicsManager::NarrowphaseModeCount);
+		ImGui::PopItemWidth();
+		PhysicsManager::SignedVolumesStatistics & signedVolumesStats = physicsManager.SignedVolumesStats;
+		ImGui::Text("Signed Volumes : %d calls, %.2f average iterations, %d shallow contacts, %d EPA fallbacks", signedVolumesStats.CallCount,
+			signedVolumesStats.CallCount > 0 ? (float)signedVolumesStats.IterationCount / signedVolumesStats.CallCount : 0.0f,
+			signedVolumesStats.ShallowContactCount, signedVolumesStats.EPAFallbackCount);
+
+		ImGui::Checkbox("Shape Pair Kernels ", &physicsManager.bIsPairKernelDispatchEnabled);
+		PhysicsManager::PairKernelStatistics & pairKernelStats = physicsManager.PairKernelStats;
+		ImGui::Text("Pair kernels : %d pairs, %d contacts, %d manifolds in use", pairKernelStats.CallCount, pairKernelStats.ContactCount,
+			(int)(physicsManager.ManifoldObjectsList.size() - physicsManager.FreeManifoldSlotList.size()));
+
+		ImGui::Checkbox("Persistent Manifolds ", &physicsManager.bIsPersistentManifoldEnabled);
+		PhysicsManager::ManifoldStatistics & manifoldStats = physicsManager.ManifoldStats;
+		ImGui::Text("Manifolds : %d contacts, %d kept from last step, %d dropped", manifoldStats.ContactCount,
+			manifoldStats.PersistentContactCount, manifoldStats.DroppedContactCount);
+
+		ImGui::Checkbox("Contact Reuse ", &physicsManager.bIsContactReuseEnabled);
+		PhysicsManager::ContactReuseStatistics & contactReuseStats = physicsManager.ContactReuseStats;
+		ImGui::Text("Contact reuse : %d of %d pairs (%.1f%%) skipped the narrowphase", contactReuseStats.HitCount, contactReuseStats.CandidateCount,
+			contactReuseStats.CandidateCount > 0 ? 100.0f * contactReuseStats.HitCount / contactReuseStats.CandidateCount : 0.0f);
+
+		ImGui::SliderInt("Max Solver Iterations: ", &PhysicsManager::ConstraintSolverIterations, 1, 30);
+		ImGui::SliderInt("Min Solver Iterations: ", &physicsManager.MinSolverIterations, 1, PhysicsManager::ConstraintSolverIterations);
+		ImGui::SliderFloat("Relative Tolerance: ", &physicsManager.IslandRelativeTolerance, 0.0f, 0.05f, "%.4f");
+		ImGui::Checkbox("Solver Warm Start ", &physicsManager.bIsWarmStartEnabled);
+		ImGui::SliderFloat("Warm Start Factor: ", &physicsManager.WarmStartFactor, 0.0f, 1.0f);
+		ImGui::Checkbox("Multithreaded Islands ", &physicsManager.bIsIslandSolverMultithreaded);
+		ImGui::Checkbox("Graph Coloring ", &physicsManager.bIsGraphColoringEnabled);
+		PhysicsManager::IslandStatistics & islandStats = physicsManager.IslandStats;
+		ImGui::Text("Islands : %d islands, largest %d constraints, %.2f average iterations, %d threads, %.3f ms", islandStats.IslandCount,
+			islandStats.LargestIslandSize, islandStats.IslandCount > 0 ? (float)islandStats.IterationCount / islandStats.IslandCount : 0.0f, islandStats.ThreadCount,
+			islandStats.SolveTime);
+		ImGui::Text("Iterations : %d this frame, at most %d in an island, largest final residual %.5f", islandStats.IterationCount,
+			islandStats.MaxIterationCount, islandStats.MaxRelativeResidual);
+		ImGui::Text("Coloring : %d islands colored, %d colors", islandStats.ColoredIslandCount, islandStats.ColorCount);
+		ImGui::Checkbox("Block Solver ", &physicsManager.bIsBlockSolverEnabled);
+		ImGui::Text("Blocks : %d manifolds solved as blocks", islandStats.BlockCount);
+		ImGui::Checkbox("Friction ", &physicsManager.bIsFrictionEnabled);
+		ImGui::Checkbox("Friction Anchor ", &physicsManager.bIsFrictionAnchorEnabled);
+		ImGui::Text("Friction : %d rows", islandStats.FrictionRowCount);
+		ImGui::Checkbox("Batch Solver ", &physicsManager.bIsBatchSolverEnabled);
+		const char * instructionSetNames[SIMD::InstructionSetCount];
+		for (int i = 0; i < SIMD::InstructionSetCount; ++i)
+			instructionSetNames[i] = SIMD::GetInstructionSetName((SIMD::InstructionSet)i);
+		ImGui::Combo("Batch Instruction Set ", (int *)&physicsManager.eSolverInstructionSet, instructionSetNames, SIMD::InstructionSetCount);
+		ImGui::Text("Batches : %d batches of %d rows, %s, %s supported", islandStats.BatchCount, ConstraintRowBatch::LaneCount,
+			SIMD::GetInstructionSetName(islandStats.InstructionSet), SIMD::GetInstructionSetName(SIMD::GetSupportedInstructionSet()));
+
+		ImGui::Checkbox("Sleeping ", &physicsManager.bIsSleepEnabled);
+		PhysicsManager::SleepStatistics & sleepStats = physicsManager.SleepStats;
+		ImGui::Text("Sleep : %d bodies asleep, %d fell asleep, %d woken, %d sleeping islands skipped", sleepStats.SleepingBodyCount,
+			sleepStats.FellAsleepCount, sleepStats.WokenCount, sleepStats.SleepingIslandCount);
+
+		ImGui::Checkbox("GJK Warm Start ", &physicsManager.bIsGJKWarmStartEnabled);
+		PhysicsManager::GJKStatistics & gjkStats = physicsManager.GJKStats;
+		ImGui::Text("GJK : %d calls, %.2f average iterations, %d warm start hits", gjkStats.CallCount,
+			gjkStats.CallCount > 0 ? (float)gjkStats.IterationCount / gjkStats.CallCount : 0.0f, gjkStats.WarmStartHitCount);
+
 		ImGui::End();
 		return true;
 	}
@@ -0,0 +1,326 @@
+#include <algorithm>
+#include "DynamicAABBTree.h"
+
+int DynamicAABBTree::CreateProxy(const AABB & aBounds, int aUserData)
+{
+	int proxyID = AllocateNode();
+
+	// Fatten the bounds
+	vector3 margin(AABBMargin);
+	Nodes[proxyID].Bounds = AABB(aBounds.Min - margin, aBounds.Max + margin);
+	Nodes[proxyID].UserData = aUserData;
+	Nodes[proxyID].Height = 0;
+
+	InsertLeaf(proxyID);
+	return proxyID;
+}
+
+void DynamicAABBTree::DestroyProxy(int aProxyID)
+{
+	RemoveLeaf(aProxyID);
+	FreeNode(aProxyID);
+}
+
+bool DynamicAABBTree::MoveProxy(int aProxyID, const AABB & aBounds, const vector3 & aDisplacement)
+{
+	// Still inside the fat bounds, the tree doesn't need to change
+	if (Nodes[aProxyID].Bounds.Contains(aBounds))
+		return false;
+
+	RemoveLeaf(aProxyID);
+
+	// Extend the bounds by the margin, and then along the direction of movement
+	vector3 margin(AABBMargin);
+	AABB fatBounds(aBounds.Min - margin, aBounds.Max + margin);
+	vector3 displacement = DisplacementMultiplier * aDisplacement;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (displacement[axis] < 0.0f)
+			fatBounds.Min[axis] += displacement[axis];
+		else
+			fatBounds.Max[axis] += displacement[axis];
+	}
+	Nodes[aProxyID].Bounds = fatBounds;
+
+	InsertLeaf(aProxyID);
+	return true;
+}
+
+int DynamicAABBTree::AllocateNode()
+{
+	// Expand the node pool if the free list is empty
+	if (FreeList == NullNode)
+	{
+		int oldCapacity = (int)Nodes.size();
+		int newCapacity = std::max(16, oldCapacity * 2);
+		Nodes.resize(newCapacity);
+
+		// Link the new nodes into the free list
+		for (int i = oldCapacity; i < newCapacity - 1; ++i)
+		{
+			Nodes[i].Next = i + 1;
+			Nodes[i].Height = -1;
+		}
+		Nodes[newCapacity - 1].Next = NullNode;
+		Nodes[newCapacity - 1].Height = -1;
+		FreeList = oldCapacity;
+	}
+
+	int nodeID = FreeList;
+	TreeNode & node = Nodes[nodeID];
+	FreeList = node.Next;
+	node.Parent = NullNode;
+	node.Child1 = NullNode;
+	node.Child2 = NullNode;
+	node.Height = 0;
+	node.UserData = -1;
+	++NodeCount;
+	return nodeID;
+}
+
+void DynamicAABBTree::FreeNode(int aNodeID)
+{
+	Nodes[aNodeID].Next = FreeList;
+	Nodes[aNodeID].Height = -1;
+	FreeList = aNodeID;
+	--NodeCount;
+}
+
+void DynamicAABBTree::InsertLeaf(int aLeaf)
+{
+	if (Root == NullNode)
+	{
+		Root = aLeaf;
+		Nodes[Root].Parent = NullNode;
+		return;
+	}
+
+	// Find the best sibling for this leaf using the surface area heuristic
+	AABB leafBounds = Nodes[aLeaf].Bounds;
+	int index = Root;
+	while (Nodes[index].IsLeaf() == false)
+	{
+		int child1 = Nodes[index].Child1;
+		int child2 = Nodes[index].Child2;
+
+		float area = Nodes[index].Bounds.SurfaceArea();
+		float combinedArea = AABB::Merge(Nodes[index].Bounds, leafBounds).SurfaceArea();
+
+		// Cost of creating a new parent for this node and the new leaf
+		float cost = 2.0f * combinedArea;
+		// Minimum cost of pushing the leaf further down the tree, every ancestor grows by the same amount
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		// Cost of descending into each child
+		float cost1 = AABB::Merge(leafBounds, Nodes[child1].Bounds).SurfaceArea() + inheritanceCost;
+		if (Nodes[child1].IsLeaf() == false)
+			cost1 -= Nodes[child1].Bounds.SurfaceArea();
+
+		float cost2 = AABB::Merge(leafBounds, Nodes[child2].Bounds).SurfaceArea() + inheritanceCost;
+		if (Nodes[child2].IsLeaf() == false)
+			cost2 -= Nodes[child2].Bounds.SurfaceArea();
+
+		// Descend according to the minimum cost
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = (cost1 < cost2) ? child1 : child2;
+	}
+	int sibling = index;
+
+	// Create a new parent for the sibling and the leaf
+	int oldParent = Nodes[sibling].Parent;
+	int newParent = AllocateNode();
+	Nodes[newParent].Parent = oldParent;
+	Nodes[newParent].Bounds = AABB::Merge(leafBounds, Nodes[sibling].Bounds);
+	Nodes[newParent].Height = Nodes[sibling].Height + 1;
+	Nodes[newParent].Child1 = sibling;
+	Nodes[newParent].Child2 = aLeaf;
+	Nodes[sibling].Parent = newParent;
+	Nodes[aLeaf].Parent = newParent;
+
+	if (oldParent != NullNode)
+	{
+		// The sibling was not the root
+		if (Nodes[oldParent].Child1 == sibling)
+			Nodes[oldParent].Child1 = newParent;
+		else
+			Nodes[oldParent].Child2 = newParent;
+	}
+	else
+	{
+		// The sibling was the root
+		Root = newParent;
+	}
+
+	RefitAncestors(Nodes[aLeaf].Parent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int aLeaf)
+{
+	if (aLeaf == Root)
+	{
+		Root = NullNode;
+		return;
+	}
+
+	int parent = Nodes[aLeaf].Parent;
+	int grandParent = Nodes[parent].Parent;
+	int sibling = (Nodes[parent].Child1 == aLeaf) ? Nodes[parent].Child2 : Nodes[parent].Child1;
+
+	if (grandParent != NullNode)
+	{
+		// Destroy the parent and connect the sibling to the grand parent
+		if (Nodes[grandParent].Child1 == parent)
+			Nodes[grandParent].Child1 = sibling;
+		else
+			Nodes[grandParent].Child2 = sibling;
+		Nodes[sibling].Parent = grandParent;
+		FreeNode(parent);
+
+		RefitAncestors(grandParent);
+	}
+	else
+	{
+		Root = sibling;
+		Nodes[sibling].Parent = NullNode;
+		FreeNode(parent);
+	}
+}
+
+void DynamicAABBTree::RefitAncestors(int aNodeID)
+{
+	int index = aNodeID;
+	while (index != NullNode)
+	{
+		index = Balance(index);
+
+		int child1 = Nodes[index].Child1;
+		int child2 = Nodes[index].Child2;
+
+		Nodes[index].Height = 1 + std::max(Nodes[child1].Height, Nodes[child2].Height);
+		Nodes[index].Bounds = AABB::Merge(Nodes[child1].Bounds, Nodes[child2].Bounds);
+
+		index = Nodes[index].Parent;
+	}
+}
+
+int DynamicAABBTree::Balance(int aNodeA)
+{
+	TreeNode & A = Nodes[aNodeA];
+	if (A.IsLeaf() || A.Height < 2)
+		return aNodeA;
+
+	int iB = A.Child1;
+	int iC = A.Child2;
+	TreeNode & B = Nodes[iB];
+	TreeNode & C = Nodes[iC];
+
+	int balance = C.Height - B.Height;
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		int iF = C.Child1;
+		int iG = C.Child2;
+		TreeNode & F = Nodes[iF];
+		TreeNode & G = Nodes[iG];
+
+		// Swap A and C
+		C.Child1 = aNodeA;
+		C.Parent = A.Parent;
+		A.Parent = iC;
+
+		// A's old parent should point to C
+		if (C.Parent != NullNode)
+		{
+			if (Nodes[C.Parent].Child1 == aNodeA)
+				Nodes[C.Parent].Child1 = iC;
+			else
+				Nodes[C.Parent].Child2 = iC;
+		}
+		else
+		{
+			Root = iC;
+		}
+
+		// Rotate
+		if (F.Height > G.Height)
+		{
+			C.Child2 = iF;
+			A.Child2 = iG;
+			G.Parent = aNodeA;
+			A.Bounds = AABB::Merge(B.Bounds, G.Bounds);
+			C.Bounds = AABB::Merge(A.Bounds, F.Bounds);
+
+			A.Height = 1 + std::max(B.Height, G.Height);
+			C.Height = 1 + std::max(A.Height, F.Height);
+		}
+		else
+		{
+			C.Child2 = iG;
+			A.Child2 = iF;
+			F.Parent = aNodeA;
+			A.Bounds = AABB::Merge(B.Bounds, F.Bounds);
+			C.Bounds = AABB::Merge(A.Bounds, G.Bounds);
+
+			A.Height = 1 + std::max(B.Height, F.Height);
+			C.Height = 1 + std::max(A.Height, G.Height);
+		}
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		int iD = B.Child1;
+		int iE = B.Child2;
+		TreeNode & D = Nodes[iD];
+		TreeNode & E = Nodes[iE];
+
+		// Swap A and B
+		B.Child1 = aNodeA;
+		B.Parent = A.Parent;
+		A.Parent = iB;
+
+		// A's old parent should point to B
+		if (B.Parent != NullNode)
+		{
+			if (Nodes[B.Parent].Child1 == aNodeA)
+				Nodes[B.Parent].Child1 = iB;
+			else
+				Nodes[B.Parent].Child2 = iB;
+		}
+		else
+		{
+			Root = iB;
+		}
+
+		// Rotate
+		if (D.Height > E.Height)
+		{
+			B.Child2 = iD;
+			A.Child1 = iE;
+			E.Parent = aNodeA;
+			A.Bounds = AABB::Merge(C.Bounds, E.Bounds);
+			B.Bounds = AABB::Merge(A.Bounds, D.Bounds);
+
+			A.Height = 1 + std::max(C.Height, E.Height);
+			B.Height = 1 + std::max(A.Height, D.Height);
+		}
+		else
+		{
+			B.Child2 = iE;
+			A.Child1 = iD;
+			D.Parent = aNodeA;
+			A.Bounds = AABB::Merge(C.Bounds, D.Bounds);
+			B.Bounds = AABB::Merge(A.Bounds, E.Bounds);
+
+			A.Height = 1 + std::max(C.Height, D.Height);
+			B.Height = 1 + std::max(A.Height, E.Height);
+		}
+		return iB;
+	}
+
+	return aNodeA;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+#include "PhysicsUtilities.h"
+
+// Dynamic bounding volume hierarchy, based on b2DynamicTree from Box2D
+// https://github.com/erincatto/Box2D/blob/master/Box2D/Collision/b2DynamicTree.h
+// Leaves hold 'fat' AABBs that are enlarged by a margin, so a proxy only needs to be reinserted
+// once its tight bounds leave the fat bounds instead of every time it moves.
+// Insertion descends the tree using the surface area heuristic (SAH) and rotations keep it balanced.
+class DynamicAABBTree
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	static const int NullNode = -1;
+
+	struct TreeNode
+	{
+		// Fat bounds for leaves, union of children bounds for internal nodes
+		AABB Bounds;
+		union
+		{
+			int Parent;
+			// Used instead of the parent when the node is in the free list
+			int Next;
+		};
+		int Child1 = NullNode;
+		int Child2 = NullNode;
+		// Leaf = 0, free node = -1
+		int Height = -1;
+		// Collider slot for leaves
+		int UserData = -1;
+
+		inline bool IsLeaf() const { return Child1 == NullNode; }
+	};
+
+	// Distance the fat bounds extend past the tight bounds on every side
+	float AABBMargin = 0.1f;
+	// Fat bounds are also extended along the displacement of the proxy, to predict where it is heading
+	float DisplacementMultiplier = 2.0f;
+private:
+	// Node pool, nodes are addressed by index so the pool can grow
+	std::vector<TreeNode> Nodes;
+	int Root = NullNode;
+	int FreeList = NullNode;
+	int NodeCount = 0;
+	// Reused by every query to avoid allocating a stack for each one
+	std::vector<int> QueryStack;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	DynamicAABBTree() {}
+
+	// Returns the ID of the new leaf
+	int CreateProxy(const AABB & aBounds, int aUserData);
+	void DestroyProxy(int aProxyID);
+	// Reinserts the proxy if its tight bounds have left the fat bounds, returns true if it was reinserted
+	bool MoveProxy(int aProxyID, const AABB & aBounds, const vector3 & aDisplacement);
+
+	inline const AABB & GetFatAABB(int aProxyID) const { return Nodes[aProxyID].Bounds; }
+	inline int GetUserData(int aProxyID) const { return Nodes[aProxyID].UserData; }
+	inline int GetHeight() const { return (Root == NullNode) ? 0 : Nodes[Root].Height; }
+	inline int GetNodeCount() const { return NodeCount; }
+
+	// Calls aCallback(proxyID) for every leaf whose fat bounds overlap aBounds, stops early if the callback returns false
+	template <typename T>
+	void Query(const AABB & aBounds, T & aCallback)
+	{
+		QueryStack.clear();
+		QueryStack.push_back(Root);
+		while (!QueryStack.empty())
+		{
+			int nodeID = QueryStack.back();
+			QueryStack.pop_back();
+			if (nodeID == NullNode)
+				continue;
+
+			const TreeNode & node = Nodes[nodeID];
+			if (node.Bounds.Overlaps(aBounds))
+			{
+				if (node.IsLeaf())
+				{
+					if (aCallback(nodeID) == false)
+						return;
+				}
+				else
+				{
+					QueryStack.push_back(node.Child1);
+					QueryStack.push_back(node.Child2);
+				}
+			}
+		}
+	}
+
+private:
+	int AllocateNode();
+	void FreeNode(int aNodeID);
+
+	void InsertLeaf(int aLeaf);
+	void RemoveLeaf(int aLeaf);
+	// Walks from a node to the root fixing heights and bounds, rebalancing along the way
+	void RefitAncestors(int aNodeID);
+	// Performs a left or right rotation if node A is imbalanced, returns the new root of the subtree
+	int Balance(int aNodeA);
+};
@@ -0,0 +1,113 @@
+#include "DynamicTreeBroadphase.h"
+#include "Collider.h"
+
+void DynamicTreeBroadphase::AddCollider(Collider * aCollider)
+{
+	int proxyID = aCollider->ColliderSlot;
+	if (proxyID >= (int)ProxyList.size())
+		ProxyList.resize(proxyID + 1);
+
+	Proxy & newProxy = ProxyList[proxyID];
+	newProxy.pCollider = aCollider;
+	newProxy.TreeProxyID = Tree.CreateProxy(aCollider->BoundingBox, proxyID);
+	newProxy.PreviousCenter = aCollider->BoundingBox.GetCenter();
+	newProxy.bIsNew = true;
+	// New proxies have to look for pairs on the next update
+	newProxy.bHasMoved = true;
+}
+
+void DynamicTreeBroadphase::RemoveCollider(Collider * aCollider)
+{
+	int proxyID = aCollider->ColliderSlot;
+	if (proxyID >= (int)ProxyList.size() || ProxyList[proxyID].pCollider == nullptr)
+		return;
+
+	for (auto iterator = OverlappingPairs.begin(); iterator != OverlappingPairs.end();)
+	{
+		if (GetFirstProxyID(*iterator) == proxyID || GetSecondProxyID(*iterator) == proxyID)
+		{
+			iterator = OverlappingPairs.erase(iterator);
+			continue;
+		}
+		++iterator;
+	}
+
+	Proxy & proxy = ProxyList[proxyID];
+	Tree.DestroyProxy(proxy.TreeProxyID);
+	proxy.TreeProxyID = DynamicAABBTree::NullNode;
+	proxy.pCollider = nullptr;
+	proxy.bHasMoved = false;
+}
+
+void DynamicTreeBroadphase::Update()
+{
+	MoveBuffer.clear();
+
+	// Refit the tree, only proxies that left their fat bounds are reinserted
+	for (int i = 0; i < (int)ProxyList.size(); ++i)
+	{
+		Proxy & proxy = ProxyList[i];
+		if (proxy.pCollider == nullptr)
+			continue;
+
+		const AABB & bounds = proxy.pCollider->BoundingBox;
+		vector3 center = bounds.GetCenter();
+		// Colliders are registered before their transform is set, so the first displacement is meaningless
+		vector3 displacement = proxy.bIsNew ? vector3(0) : center - proxy.PreviousCenter;
+		proxy.PreviousCenter = center;
+		proxy.bIsNew = false;
+
+		if (Tree.MoveProxy(proxy.TreeProxyID, bounds, displacement))
+			proxy.bHasMoved = true;
+		if (proxy.bHasMoved)
+			MoveBuffer.push_back(i);
+	}
+
+	if (MoveBuffer.empty())
+		return;
+
+	// Pairs can only stop overlapping if one of them was reinserted with new fat bounds
+	for (auto iterator = OverlappingPairs.begin(); iterator != OverlappingPairs.end();)
+	{
+		Proxy & proxyA = ProxyList[GetFirstProxyID(*iterator)];
+		Proxy & proxyB = ProxyList[GetSecondProxyID(*iterator)];
+		if ((proxyA.bHasMoved || proxyB.bHasMoved) &&
+			Tree.GetFatAABB(proxyA.TreeProxyID).Overlaps(Tree.GetFatAABB(proxyB.TreeProxyID)) == false)
+		{
+			iterator = OverlappingPairs.erase(iterator);
+			continue;
+		}
+		++iterator;
+	}
+
+	// Only moved proxies query the tree for new pairs
+	for (int movedProxyID : MoveBuffer)
+	{
+		Proxy & movedProxy = ProxyList[movedProxyID];
+		auto queryCallback = [&](int aTreeProxyID)
+		{
+			int otherProxyID = Tree.GetUserData(aTreeProxyID);
+			// If both proxies moved the pair is only added by one of them
+			if (otherProxyID == movedProxyID || (ProxyList[otherProxyID].bHasMoved && otherProxyID < movedProxyID))
+				return true;
+			OverlappingPairs.insert(GetPairKey(movedProxyID, otherProxyID));
+			return true;
+		};
+		Tree.Query(Tree.GetFatAABB(movedProxy.TreeProxyID), queryCallback);
+	}
+
+	for (int movedProxyID : MoveBuffer)
+		ProxyList[movedProxyID].bHasMoved = false;
+}
+
+void DynamicTreeBroadphase::FindOverlappingPairs(std::vector<ColliderPair>& aPairList)
+{
+	for (unsigned long long pairKey : OverlappingPairs)
+	{
+		Collider * colliderA = ProxyList[GetFirstProxyID(pairKey)].pCollider;
+		Collider * colliderB = ProxyList[GetSecondProxyID(pairKey)].pCollider;
+		// Fat bounds are conservative, only pass on pairs whose tight bounds overlap this frame
+		if (colliderA->BoundingBox.Overlaps(colliderB->BoundingBox))
+			aPairList.emplace_back(colliderA, colliderB);
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include <unordered_set>
+#include "Broadphase.h"
+#include "DynamicAABBTree.h"
+
+// Broadphase built on a dynamic AABB tree, based on b2BroadPhase from Box2D
+// Only proxies that left their fat bounds this frame are reinserted and query the tree for new pairs,
+// so the cost scales with the number of moving bodies rather than the total number of colliders.
+class DynamicTreeBroadphase : public Broadphase
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	DynamicAABBTree Tree;
+private:
+	struct Proxy
+	{
+		Collider * pCollider = nullptr;
+		int TreeProxyID = DynamicAABBTree::NullNode;
+		// Used to find the displacement of the proxy since the last frame
+		vector3 PreviousCenter;
+		bool bHasMoved = false;
+		bool bIsNew = true;
+	};
+	// Indexed by collider slot
+	std::vector<Proxy> ProxyList;
+	// Collider slots of the proxies that were reinserted this frame
+	std::vector<int> MoveBuffer;
+	// Pairs whose fat bounds overlap, key is made from the two collider slots
+	std::unordered_set<unsigned long long> OverlappingPairs;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	virtual void AddCollider(Collider * aCollider) override;
+	virtual void RemoveCollider(Collider * aCollider) override;
+	virtual void Update() override;
+	virtual void FindOverlappingPairs(std::vector<ColliderPair> & aPairList) override;
+
+	inline int GetMovedProxyCount() { return (int)MoveBuffer.size(); }
+};
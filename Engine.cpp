@@ -196,6 +196,9 @@ void Engine::Load()
 	// Notify all listeners to engine load
 	MainEventList[EngineEvent::ENGINE_LOAD].NotifyAllObservers(&LoadEvent);
 
+	// Colliders have been initialized by their owners on load, static ones won't change after this
+	pPhysicsManager->BuildStaticGeometry();
+
 	return;
 }
 
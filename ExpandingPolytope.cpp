@@ -0,0 +1,171 @@
+#include <utility>
+#include "ExpandingPolytope.h"
+
+bool ExpandingPolytope::Initialize(const Simplex & aSimplex)
+{
+	VertexCount = 0;
+	FaceCount = 0;
+	HeapSize = 0;
+	HorizonSize = 0;
+
+	for (int i = 0; i < 4; ++i)
+		VertexList[VertexCount++] = aSimplex.Vertices[i];
+
+	// Faces below are wound outwards only if the fourth vertex is behind the first face
+	vector3 a = VertexList[0].MinkowskiHullVertex;
+	float orientation = glm::dot(glm::cross(VertexList[1].MinkowskiHullVertex - a, VertexList[2].MinkowskiHullVertex - a), VertexList[3].MinkowskiHullVertex - a);
+	if (orientation == 0.0f)
+		return false;
+	if (orientation > 0.0f)
+		std::swap(VertexList[0], VertexList[1]);
+
+	const int tetrahedronFaces[4][3] = { { 0, 1, 2 }, { 0, 2, 3 }, { 0, 3, 1 }, { 1, 3, 2 } };
+	for (int i = 0; i < 4; ++i)
+	{
+		if (AddFace(tetrahedronFaces[i][0], tetrahedronFaces[i][1], tetrahedronFaces[i][2]) < 0)
+			return false;
+	}
+
+	// Every edge of the tetrahedron is shared with the face that has it in the opposite direction
+	for (int faceA = 0; faceA < 4; ++faceA)
+	{
+		for (int edgeA = 0; edgeA < 3; ++edgeA)
+		{
+			int start = FaceList[faceA].Vertices[edgeA];
+			int end = FaceList[faceA].Vertices[(edgeA + 1) % 3];
+			for (int faceB = 0; faceB < 4; ++faceB)
+			{
+				for (int edgeB = 0; edgeB < 3; ++edgeB)
+				{
+					if (FaceList[faceB].Vertices[edgeB] == end && FaceList[faceB].Vertices[(edgeB + 1) % 3] == start)
+						Link(FaceList[faceA], faceA, edgeA, FaceList[faceB], faceB, edgeB);
+				}
+			}
+		}
+	}
+	return true;
+}
+
+int ExpandingPolytope::PopClosestFace()
+{
+	while (HeapSize > 0)
+	{
+		int faceIndex = Heap[0].FaceIndex;
+
+		// Move the last entry to the top and sift it down
+		HeapEntry entry = Heap[--HeapSize];
+		int index = 0;
+		while (true)
+		{
+			int child = 2 * index + 1;
+			if (child >= HeapSize)
+				break;
+			if (child + 1 < HeapSize && Heap[child + 1].Distance < Heap[child].Distance)
+				++child;
+			if (entry.Distance <= Heap[child].Distance)
+				break;
+			Heap[index] = Heap[child];
+			index = child;
+		}
+		Heap[index] = entry;
+
+		if (FaceList[faceIndex].bIsRemoved == false)
+			return faceIndex;
+	}
+	return -1;
+}
+
+bool ExpandingPolytope::Expand(int aVisibleFace, const SupportPoint & aNewVertex)
+{
+	if (VertexCount == MaxVertexCount)
+		return false;
+	int newVertex = VertexCount++;
+	VertexList[newVertex] = aNewVertex;
+
+	HorizonSize = 0;
+	Face & visibleFace = FaceList[aVisibleFace];
+	visibleFace.bIsRemoved = true;
+	for (int edge = 0; edge < 3; ++edge)
+		FindHorizon(visibleFace.AdjacentFaces[edge], visibleFace.AdjacentEdges[edge], newVertex);
+
+	if (HorizonSize < 3)
+		return false;
+
+	// The horizon is walked in order, so each new face shares its second edge with the next one and the fan closes on the first
+	int firstFace = -1;
+	int previousFace = -1;
+	for (int i = 0; i < HorizonSize; ++i)
+	{
+		int hiddenFaceIndex = Horizon[i].FaceIndex;
+		int hiddenEdge = Horizon[i].EdgeIndex;
+		int newFace = AddFace(FaceList[hiddenFaceIndex].Vertices[(hiddenEdge + 1) % 3], FaceList[hiddenFaceIndex].Vertices[hiddenEdge], newVertex);
+		if (newFace < 0)
+			return false;
+
+		Link(FaceList[newFace], newFace, 0, FaceList[hiddenFaceIndex], hiddenFaceIndex, hiddenEdge);
+		if (previousFace < 0)
+			firstFace = newFace;
+		else
+			Link(FaceList[previousFace], previousFace, 1, FaceList[newFace], newFace, 2);
+		previousFace = newFace;
+	}
+	Link(FaceList[previousFace], previousFace, 1, FaceList[firstFace], firstFace, 2);
+	return true;
+}
+
+int ExpandingPolytope::AddFace(int aVertexA, int aVertexB, int aVertexC)
+{
+	if (FaceCount == MaxFaceCount)
+		return -1;
+
+	const vector3 & a = VertexList[aVertexA].MinkowskiHullVertex;
+	vector3 normal = glm::cross(VertexList[aVertexB].MinkowskiHullVertex - a, VertexList[aVertexC].MinkowskiHullVertex - a);
+	float length = glm::length(normal);
+	if (length < 1e-8f)
+		return -1;
+
+	int faceIndex = FaceCount++;
+	Face & face = FaceList[faceIndex];
+	face.Vertices[0] = aVertexA;
+	face.Vertices[1] = aVertexB;
+	face.Vertices[2] = aVertexC;
+	face.AdjacentFaces[0] = face.AdjacentFaces[1] = face.AdjacentFaces[2] = -1;
+	face.AdjacentEdges[0] = face.AdjacentEdges[1] = face.AdjacentEdges[2] = -1;
+	face.Normal = normal / length;
+	face.Distance = glm::dot(face.Normal, a);
+	face.bIsRemoved = false;
+
+	// Sift the new entry up the heap
+	int index = HeapSize++;
+	while (index > 0)
+	{
+		int parent = (index - 1) / 2;
+		if (Heap[parent].Distance <= face.Distance)
+			break;
+		Heap[index] = Heap[parent];
+		index = parent;
+	}
+	Heap[index].Distance = face.Distance;
+	Heap[index].FaceIndex = faceIndex;
+	return faceIndex;
+}
+
+void ExpandingPolytope::FindHorizon(int aFaceIndex, int aEdgeIndex, int aVertex)
+{
+	Face & face = FaceList[aFaceIndex];
+	if (face.bIsRemoved)
+		return;
+
+	// Faces the new vertex is in front of are removed, a face it is behind borders the hole with this edge
+	const vector3 & vertex = VertexList[aVertex].MinkowskiHullVertex;
+	if (glm::dot(face.Normal, vertex) - face.Distance <= 0.0f)
+	{
+		if (HorizonSize < 2 * MaxVertexCount)
+			Horizon[HorizonSize++] = { aFaceIndex, aEdgeIndex };
+		return;
+	}
+
+	face.bIsRemoved = true;
+	FindHorizon(face.AdjacentFaces[(aEdgeIndex + 1) % 3], face.AdjacentEdges[(aEdgeIndex + 1) % 3], aVertex);
+	FindHorizon(face.AdjacentFaces[(aEdgeIndex + 2) % 3], face.AdjacentEdges[(aEdgeIndex + 2) % 3], aVertex);
+}
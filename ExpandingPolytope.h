@@ -0,0 +1,78 @@
+#pragma once
+#include "PhysicsUtilities.h"
+
+// Fixed capacity polytope used by EPA, nothing is allocated once it has been constructed
+// Vertices are stored once and faces reference them by index. Every face keeps the face and edge on the other side of each of its edges,
+// so the horizon seen from a new vertex is found by walking the faces it can see, as in Bullet's gjkepa2.
+// Face distances are cached in a binary min heap, faces removed by an expansion are skipped when they reach the top.
+class ExpandingPolytope
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	struct Face
+	{
+		int Vertices[3];
+		// Face across the edge from Vertices[i] to Vertices[(i + 1) % 3], and the index of that edge in it
+		int AdjacentFaces[3];
+		int AdjacentEdges[3];
+		// Unit length, pointing away from the polytope
+		vector3 Normal;
+		// Distance from the origin to the plane of the face
+		float Distance;
+		bool bIsRemoved;
+	};
+
+	// EPA adds a single vertex per iteration
+	static const int MaxVertexCount = 64;
+	// Removed faces are not reused so that heap entries never point at a different face, every face ever created needs a slot
+	static const int MaxFaceCount = 512;
+private:
+	struct HeapEntry
+	{
+		float Distance;
+		int FaceIndex;
+	};
+	struct HorizonEdge
+	{
+		int FaceIndex;
+		int EdgeIndex;
+	};
+
+	SupportPoint VertexList[MaxVertexCount];
+	int VertexCount = 0;
+	Face FaceList[MaxFaceCount];
+	int FaceCount = 0;
+	HeapEntry Heap[MaxFaceCount];
+	int HeapSize = 0;
+	// A convex polytope with V vertices has at most 2V - 4 faces, so the horizon has fewer than that many edges
+	HorizonEdge Horizon[2 * MaxVertexCount];
+	int HorizonSize = 0;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	// Starts from the tetrahedron GJK found, returns false if it is degenerate
+	bool Initialize(const Simplex & aSimplex);
+	// Index of the closest face to the origin that is still part of the polytope, -1 once there are none left
+	int PopClosestFace();
+	// Adds the support point found along the normal of aVisibleFace, which must be able to see it,
+	// and replaces every face it can see with a fan of faces around it. False if out of capacity or a new face is degenerate
+	bool Expand(int aVisibleFace, const SupportPoint & aNewVertex);
+
+	inline const Face & GetFace(int aFaceIndex) const { return FaceList[aFaceIndex]; }
+	inline const SupportPoint & GetVertex(int aVertexIndex) const { return VertexList[aVertexIndex]; }
+	inline int GetVertexCount() const { return VertexCount; }
+	inline int GetFaceCount() const { return FaceCount; }
+
+private:
+	// Returns the index of the new face, -1 if out of capacity or the face is degenerate
+	int AddFace(int aVertexA, int aVertexB, int aVertexC);
+	// Removes the faces visible from aVertex reachable through the edge, and records the edges between visible and hidden faces in order
+	void FindHorizon(int aFaceIndex, int aEdgeIndex, int aVertex);
+
+	static inline void Link(Face & aFaceA, int aFaceIndexA, int aEdgeA, Face & aFaceB, int aFaceIndexB, int aEdgeB)
+	{
+		aFaceA.AdjacentFaces[aEdgeA] = aFaceIndexB;
+		aFaceA.AdjacentEdges[aEdgeA] = aEdgeB;
+		aFaceB.AdjacentFaces[aEdgeB] = aFaceIndexA;
+		aFaceB.AdjacentEdges[aEdgeB] = aEdgeA;
+	}
+};
@@ -21,6 +21,9 @@
 #include "Controller.h"
 #include "Script.h"
 #include "Box.h"
+#include "Sphere.h"
+#include "Capsule.h"
+#include "ConvexHull.h"
 #include "Light.h"
 
 class Engine;
@@ -81,6 +84,21 @@ public:
 			mComponent = new Box();
 			EngineHandle.GetPhysicsManager().RegisterColliderObject(static_cast<Collider *>(mComponent));
 		}
+		else if (typeid(T) == typeid(Sphere))
+		{
+			mComponent = new Sphere();
+			EngineHandle.GetPhysicsManager().RegisterColliderObject(static_cast<Collider *>(mComponent));
+		}
+		else if (typeid(T) == typeid(Capsule))
+		{
+			mComponent = new Capsule();
+			EngineHandle.GetPhysicsManager().RegisterColliderObject(static_cast<Collider *>(mComponent));
+		}
+		else if (typeid(T) == typeid(ConvexHull))
+		{
+			mComponent = new ConvexHull();
+			EngineHandle.GetPhysicsManager().RegisterColliderObject(static_cast<Collider *>(mComponent));
+		}
 		else if (typeid(T) == typeid(Light))
 		{
 			mComponent = new Light();
@@ -0,0 +1,33 @@
+#include <utility>
+#include "NarrowphaseDispatch.h"
+// Headers registering kernels
+#include "BoxBoxCollision.h"
+#include "RoundShapeCollision.h"
+
+namespace
+{
+	const int ShapeTypeCount = Collider::ShapeTypeCount;
+
+	template <typename Indices>
+	struct KernelTable;
+
+	// One entry per ordered pair of shape types, row major on the first shape
+	template <size_t... Indices>
+	struct KernelTable<std::index_sequence<Indices...>>
+	{
+		static const NarrowphaseDispatch::Kernel Kernels[sizeof...(Indices)];
+	};
+
+	template <size_t... Indices>
+	const NarrowphaseDispatch::Kernel KernelTable<std::index_sequence<Indices...>>::Kernels[sizeof...(Indices)] =
+	{
+		NarrowphaseDispatch::GetKernel<Collider::ShapeType(Indices / ShapeTypeCount), Collider::ShapeType(Indices % ShapeTypeCount)>()...
+	};
+
+	typedef KernelTable<std::make_index_sequence<ShapeTypeCount * ShapeTypeCount>> ShapePairKernelTable;
+}
+
+NarrowphaseDispatch::Kernel NarrowphaseDispatch::FindKernel(Collider::ShapeType aShapeA, Collider::ShapeType aShapeB)
+{
+	return ShapePairKernelTable::Kernels[aShapeA * ShapeTypeCount + aShapeB];
+}
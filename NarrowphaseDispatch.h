@@ -0,0 +1,46 @@
+#pragma once
+#include <utility>
+#include "Collider.h"
+
+// Double dispatch of the narrowphase on the shape types of a pair, through a table built at compile time
+// A shape pair gets a specialized kernel by specializing PairKernel for its two shape types next to the kernel,
+// and including that header in NarrowphaseDispatch.cpp. The kernel for the swapped pair is generated from it.
+// Pairs with no kernel either way have a null entry and go through the generic GJK path.
+namespace NarrowphaseDispatch
+{
+	// Replaces the contents of aManifold and returns true if the shapes overlap, contact normals point from aColliderA to aColliderB
+	typedef bool (*Kernel)(Collider & aColliderA, Collider & aColliderB, ContactManifold & aManifold);
+
+	template <Collider::ShapeType ShapeA, Collider::ShapeType ShapeB>
+	struct PairKernel
+	{
+		static const bool bIsDefined = false;
+		static inline bool Collide(Collider &, Collider &, ContactManifold &) { return false; }
+	};
+
+	// Runs the kernel registered for (ShapeB, ShapeA) and swaps the roles of the two shapes in the contacts it found
+	template <Collider::ShapeType ShapeA, Collider::ShapeType ShapeB>
+	bool CollideSwapped(Collider & aColliderA, Collider & aColliderB, ContactManifold & aManifold)
+	{
+		if (PairKernel<ShapeB, ShapeA>::Collide(aColliderB, aColliderA, aManifold) == false)
+			return false;
+		for (int i = 0; i < aManifold.Size; ++i)
+		{
+			ContactData & contact = aManifold.ManifoldPoints[i];
+			std::swap(contact.ContactPositionA_WS, contact.ContactPositionB_WS);
+			std::swap(contact.ContactPositionA_LS, contact.ContactPositionB_LS);
+			contact.Normal = -contact.Normal;
+		}
+		return true;
+	}
+
+	template <Collider::ShapeType ShapeA, Collider::ShapeType ShapeB>
+	constexpr Kernel GetKernel()
+	{
+		return PairKernel<ShapeA, ShapeB>::bIsDefined ? &PairKernel<ShapeA, ShapeB>::Collide :
+			(PairKernel<ShapeB, ShapeA>::bIsDefined ? &CollideSwapped<ShapeA, ShapeB> : nullptr);
+	}
+
+	// Null if the pair has no specialized kernel
+	Kernel FindKernel(Collider::ShapeType aShapeA, Collider::ShapeType aShapeB);
+}
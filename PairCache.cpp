@@ -0,0 +1,154 @@
+#include <utility>
+#include "PairCache.h"
+
+PairCache::CachedPair * PairCache::Find(int aSlotA, int aSlotB)
+{
+	if (PairCount == 0)
+		return nullptr;
+
+	if (aSlotA > aSlotB)
+		std::swap(aSlotA, aSlotB);
+	size_t index = FindIndex(Table, GetPairKey(aSlotA, aSlotB));
+	return (Table[index].Key == EmptyKey) ? nullptr : &Table[index];
+}
+
+PairCache::CachedPair & PairCache::FindOrAdd(int aSlotA, int aSlotB, unsigned int aStep)
+{
+	// Keep the load factor at or below one half so probe sequences stay short
+	if (2 * (size_t)(PairCount + 1) > Table.size())
+		Rehash(Table.empty() ? 64 : Table.size() * 2);
+
+	if (aSlotA > aSlotB)
+		std::swap(aSlotA, aSlotB);
+	unsigned long long key = GetPairKey(aSlotA, aSlotB);
+	CachedPair & cachedPair = Table[FindIndex(Table, key)];
+	if (cachedPair.Key == EmptyKey)
+	{
+		cachedPair = CachedPair();
+		cachedPair.Key = key;
+		cachedPair.SlotA = aSlotA;
+		cachedPair.SlotB = aSlotB;
+		cachedPair.Flags = NEW_PAIR;
+		++PairCount;
+	}
+	cachedPair.LastTouchedStep = aStep;
+	return cachedPair;
+}
+
+int PairCache::EvictStalePairs(unsigned int aCurrentStep)
+{
+	// Rebuilding is linear in the table size, cheaper than backward shift deletion when many pairs leave at once
+	SwapTable.assign(Table.size(), CachedPair());
+	int survivorCount = 0;
+	for (CachedPair & cachedPair : Table)
+	{
+		if (cachedPair.Key == EmptyKey)
+			continue;
+		if (cachedPair.LastTouchedStep != aCurrentStep && cachedPair.pConstraint == nullptr)
+		{
+			if (cachedPair.ManifoldID >= 0)
+				ReleasedManifoldList.push_back(cachedPair.ManifoldID);
+			continue;
+		}
+
+		cachedPair.Flags &= ~NEW_PAIR;
+		SwapTable[FindIndex(SwapTable, cachedPair.Key)] = cachedPair;
+		++survivorCount;
+	}
+	std::swap(Table, SwapTable);
+
+	EvictedPairCount = PairCount - survivorCount;
+	PairCount = survivorCount;
+	return EvictedPairCount;
+}
+
+void PairCache::RemovePairsWithSlot(int aSlot)
+{
+	if (PairCount == 0)
+		return;
+
+	SwapTable.assign(Table.size(), CachedPair());
+	int survivorCount = 0;
+	for (CachedPair & cachedPair : Table)
+	{
+		if (cachedPair.Key == EmptyKey)
+			continue;
+		if (cachedPair.SlotA == aSlot || cachedPair.SlotB == aSlot)
+		{
+			if (cachedPair.ManifoldID >= 0)
+				ReleasedManifoldList.push_back(cachedPair.ManifoldID);
+			continue;
+		}
+
+		SwapTable[FindIndex(SwapTable, cachedPair.Key)] = cachedPair;
+		++survivorCount;
+	}
+	std::swap(Table, SwapTable);
+	PairCount = survivorCount;
+}
+
+void PairCache::MoveSlot(int aOldSlot, int aNewSlot)
+{
+	if (PairCount == 0)
+		return;
+
+	SwapTable.assign(Table.size(), CachedPair());
+	for (CachedPair & cachedPair : Table)
+	{
+		if (cachedPair.Key == EmptyKey)
+			continue;
+
+		if (cachedPair.SlotA == aOldSlot || cachedPair.SlotB == aOldSlot)
+		{
+			int slotA = (cachedPair.SlotA == aOldSlot) ? aNewSlot : cachedPair.SlotA;
+			int slotB = (cachedPair.SlotB == aOldSlot) ? aNewSlot : cachedPair.SlotB;
+			// Slots are kept ordered, if they swap around the colliders swap roles and nothing built for the old order applies anymore:
+			// the warm start data, the manifold's local points and pose, and the constraints' A and B
+			if (slotA > slotB)
+			{
+				std::swap(slotA, slotB);
+				cachedPair.Flags &= ~(HAS_SEPARATING_AXIS | HAS_SIMPLEX | HAS_CONTACT_POSE);
+				if (cachedPair.ManifoldID >= 0)
+					ReleasedManifoldList.push_back(cachedPair.ManifoldID);
+				cachedPair.ManifoldID = -1;
+				if (cachedPair.pConstraint)
+					ReleasedConstraintList.push_back(cachedPair.pConstraint);
+				cachedPair.pConstraint = nullptr;
+			}
+			cachedPair.SlotA = slotA;
+			cachedPair.SlotB = slotB;
+			cachedPair.Key = GetPairKey(slotA, slotB);
+		}
+		SwapTable[FindIndex(SwapTable, cachedPair.Key)] = cachedPair;
+	}
+	std::swap(Table, SwapTable);
+}
+
+void PairCache::Clear()
+{
+	for (CachedPair & cachedPair : Table)
+		cachedPair = CachedPair();
+	PairCount = 0;
+	EvictedPairCount = 0;
+}
+
+size_t PairCache::FindIndex(const std::vector<CachedPair> & aTable, unsigned long long aKey)
+{
+	size_t mask = aTable.size() - 1;
+	size_t index = HashPairKey(aKey) & mask;
+	// Linear probing, the table is never full so this always stops
+	while (aTable[index].Key != aKey && aTable[index].Key != EmptyKey)
+		index = (index + 1) & mask;
+	return index;
+}
+
+void PairCache::Rehash(size_t aNewCapacity)
+{
+	SwapTable.assign(aNewCapacity, CachedPair());
+	for (CachedPair & cachedPair : Table)
+	{
+		if (cachedPair.Key != EmptyKey)
+			SwapTable[FindIndex(SwapTable, cachedPair.Key)] = cachedPair;
+	}
+	std::swap(Table, SwapTable);
+}
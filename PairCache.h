@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include "Typedefs.h"
+
+class ContactConstraint;
+
+// Persistent map from a pair of collider slots to whatever is kept alive between steps for that pair
+// Open addressing hash table with linear probing, the pair key is the two slots ordered and packed together.
+// Lookups and insertions are O(1), stale pairs are evicted in bulk at the end of the step by rebuilding the table.
+class PairCache
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	enum PairFlags
+	{
+		// Set on pairs added during the current step, cleared when stale pairs are evicted
+		NEW_PAIR = 1 << 0,
+		// GJK warm start data, set depending on whether the pair was separated or touching the last time GJK ran
+		HAS_SEPARATING_AXIS = 1 << 1,
+		HAS_SIMPLEX = 1 << 2,
+		// ContactRelativeTransform holds the pose the pair's manifold was last built at
+		HAS_CONTACT_POSE = 1 << 3,
+		// Flags from here on are free to be used by whoever owns the cache
+		FIRST_USER_FLAG = 1 << 8
+	};
+
+	static const unsigned long long EmptyKey = ~0ull;
+
+	struct CachedPair
+	{
+		unsigned long long Key = EmptyKey;
+		// Ordered, SlotA < SlotB
+		int SlotA = -1;
+		int SlotB = -1;
+		// Contact constraint currently being solved for this pair, null if there is none
+		ContactConstraint * pConstraint = nullptr;
+		// Slot in the manifold objects list, -1 if the pair has no manifold
+		int ManifoldID = -1;
+		unsigned int LastTouchedStep = 0;
+		unsigned int Flags = 0;
+
+		// Last search direction that proved the pair was separated
+		vector3 SeparatingAxis;
+		// Object space support points of the last simplex that contained the origin,
+		// transformed by the current model matrices they rebuild the simplex for the new positions
+		vector3 LocalSimplexPointsA[4];
+		vector3 LocalSimplexPointsB[4];
+		// Pose of B in the space of A the last time the narrowphase ran, its manifold is reused while the pose stays close to it
+		matrix4 ContactRelativeTransform;
+	};
+private:
+	// Size is always a power of two, and kept at least twice the pair count
+	std::vector<CachedPair> Table;
+	// Eviction rebuilds the table into this one and swaps them, so no memory is allocated once both have grown
+	std::vector<CachedPair> SwapTable;
+	int PairCount = 0;
+	int EvictedPairCount = 0;
+public:
+	// Manifold slots of the pairs removed by EvictStalePairs and RemovePairsWithSlot, or reordered by MoveSlot, the owner releases them and clears the list
+	std::vector<int> ReleasedManifoldList;
+	// Single contact constraints of the pairs reordered by MoveSlot, the owner deletes them and clears the list
+	std::vector<ContactConstraint *> ReleasedConstraintList;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	// Returns null if the pair isn't cached
+	CachedPair * Find(int aSlotA, int aSlotB);
+	// Adds the pair if it isn't cached yet and marks it as touched during aStep
+	// The returned reference is only valid until the next call to FindOrAdd, which might grow the table
+	CachedPair & FindOrAdd(int aSlotA, int aSlotB, unsigned int aStep);
+	// Removes every pair that was not touched during aCurrentStep and has no constraint left, returns the number removed
+	int EvictStalePairs(unsigned int aCurrentStep);
+	// Removes every pair involving the slot, used when the collider in that slot is unregistered
+	void RemovePairsWithSlot(int aSlot);
+	// Re-keys every pair involving aOldSlot when a collider is moved to another slot, keeping its cached data unless the two slots change order
+	void MoveSlot(int aOldSlot, int aNewSlot);
+	void Clear();
+
+	inline int GetPairCount() const { return PairCount; }
+	inline int GetCapacity() const { return (int)Table.size(); }
+	inline int GetEvictedPairCount() const { return EvictedPairCount; }
+
+private:
+	// Index of the entry holding aKey, or of the empty entry where it would be inserted
+	static size_t FindIndex(const std::vector<CachedPair> & aTable, unsigned long long aKey);
+	void Rehash(size_t aNewCapacity);
+
+	static inline unsigned long long GetPairKey(int aSlotA, int aSlotB)
+	{
+		return ((unsigned long long)aSlotA << 32) | (unsigned int)aSlotB;
+	}
+	// 64 bit finalizer from MurmurHash3
+	static inline unsigned long long HashPairKey(unsigned long long aKey)
+	{
+		aKey ^= aKey >> 33;
+		aKey *= 0xff51afd7ed558ccdull;
+		aKey ^= aKey >> 33;
+		aKey *= 0xc4ceb9fe1a85ec53ull;
+		aKey ^= aKey >> 33;
+		return aKey;
+	}
+};
@@ -4,10 +4,41 @@
 #include "Controller.h"
 #include "Collider.h"
 
+int Physics::WakeUpCount = 0;
+
 void Physics::Initialize()
 {
 }
 
+void Physics::WakeUp()
+{
+	SleepTimer = 0.0f;
+	if (bIsAsleep == false)
+		return;
+	bIsAsleep = false;
+	++WakeUpCount;
+}
+
+void Physics::FallAsleep()
+{
+	bIsAsleep = true;
+	CurrentLinearVelocity = PreviousLinearVelocity = vector3(0);
+	CurrentAngularVelocity = PreviousAngularVelocity = vector3(0);
+
+	Transform * transform = GetOwner()->GetComponent<Transform>();
+	CurrentPosition = transform->Position;
+	SleepRotation = transform->Rotation;
+}
+
+void Physics::WakeUpIfMoved()
+{
+	if (bIsAsleep == false)
+		return;
+	Transform * transform = GetOwner()->GetComponent<Transform>();
+	if (transform->Position != CurrentPosition || transform->Rotation != SleepRotation)
+		WakeUp();
+}
+
 void Physics::SyncPhysicsWithTransform()
 {
 	Transform * transform = this->GetOwner()->GetComponent<Transform>();
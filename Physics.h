@@ -34,6 +34,15 @@ public:
 
 	bool bShouldGravityAffect = true;
 	float GravityMagnitude = -0.8f;
+
+	// Sleeping bodies are skipped by integration, bounds updates and the solver until something wakes them
+	bool bIsAsleep = false;
+	// Seconds the body has stayed under the sleep velocity thresholds
+	float SleepTimer = 0.0f;
+	// Rotation when the body fell asleep, CurrentPosition still holds its position
+	quaternion SleepRotation;
+	// Bodies woken since the physics manager last reset it, for profiling
+	static int WakeUpCount;
 	/* -------- FUNCTIONS ---------- */
 	
 	Physics() : Component(Component::PHYSICS)
@@ -50,7 +59,12 @@ public:
 	inline void SetMass(float mass) { Mass = mass; InverseMass = 1 / Mass; }
 	inline void SetCurrentPosition(vector3 position) { CurrentPosition = position; }
 	inline void SetNextPosition(vector3 position) { NextPosition = position; }
-	inline void ApplyForce(vector3 newForce) { Force += newForce; }
+	inline void ApplyForce(vector3 newForce) { Force += newForce; WakeUp(); }
+
+	void WakeUp();
+	void FallAsleep();
+	// Wakes the body if its transform was changed while it was asleep, by the editor or a controller
+	void WakeUpIfMoved();
 
 	virtual void Initialize() override;
 	virtual void Deserialize(TextFileData & aTextFileData) override {};
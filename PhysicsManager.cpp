@@ -1,4 +1,7 @@
-﻿#include <list>
+﻿#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <thread>
 
 #include "PhysicsManager.h"
 #include "Renderer.h"
@@ -15,11 +18,27 @@
 #include "Collider.h"
 #include "Primitive.h"
 #include "ContactConstraint.h"
+#include "NarrowphaseDispatch.h"
+#include "ThreadBarrier.h"
 
 #include "UtilityFunctions.h"
 #include "MathUtilities.h"
 
 int PhysicsManager::IntegratorIterations = 1;
+int PhysicsManager::ConstraintSolverIterations = 10;
+const char * PhysicsManager::BroadphaseModeName[PhysicsManager::BroadphaseModeCount] =
+{
+	"Brute Force",
+	"Sweep and Prune",
+	"Dynamic AABB Tree",
+	"Spatial Hash Grid"
+};
+const char * PhysicsManager::NarrowphaseModeName[PhysicsManager::NarrowphaseModeCount] =
+{
+	"GJK + EPA",
+	"Signed Volumes GJK"
+};
+
 void PhysicsManager::Update()
 {
 	// Three Stages
@@ -30,200 +49,547 @@ void PhysicsManager::Update()
 	if (EngineHandle.GetInputManager().isKeyPressed(GLFW_KEY_LEFT_ALT) == true)
 		EngineHandle.GetEngineStateManager().bShouldSimulationRun = true;
 
-	// Collision Detection : Check every Collider for collision against every other Collider
+	// Collision Detection : Check every pair of Colliders found by the broadphase for collision
 	DetectCollision();
 
 	// Constraint Resolution: Solve all the constraints that were violated this frame using sequential impulse solver
 	// http://www.bulletphysics.com/ftp/pub/test/physics/papers/IterativeDynamics.pdf
 	if(EngineHandle.GetEngineStateManager().bShouldSimulationRun == true)
+	{
 		SolveConstraints();
+		UpdateSleep();
+	}
+
+	// Pairs that left the broadphase this step and whose constraint has been discarded are no longer needed
+	CollisionPairCache.EvictStalePairs(StepCount);
+	ReleaseEvictedManifolds();
+	++StepCount;
 }
 
 void PhysicsManager::DetectCollision()
 {
+	UpdateColliderBounds();
+
+	// Broadphase : Only pairs whose bounds overlap are passed on to GJK
+	double broadphaseStartTime = glfwGetTime();
+	FindCollisionPairs();
+	double narrowphaseStartTime = glfwGetTime();
+
+	// Every collider is Green unless it is part of a colliding pair
+	// Static colliders are only reset if they were colliding last frame, rebuffering every static mesh each frame is expensive
+	for (Collider * collider : DynamicColliderList)
+	{
+		Primitive * mesh = collider->GetOwner()->GetComponent<Primitive>();
+		mesh->SetVertexColorsUniform(vector3(0.0f, 1.0f, 0.0f));
+	}
+	for (Collider * collider : CollidingStaticColliderList)
+	{
+		Primitive * mesh = collider->GetOwner()->GetComponent<Primitive>();
+		mesh->SetVertexColorsUniform(vector3(0.0f, 1.0f, 0.0f));
+	}
+	CollidingStaticColliderList.clear();
+
+	int collidingPairCount = 0;
+	GJKStats = GJKStatistics();
+	SignedVolumesStats = SignedVolumesStatistics();
+	PairKernelStats = PairKernelStatistics();
+	ManifoldStats = ManifoldStatistics();
+	ContactReuseStats = ContactReuseStatistics();
 	// Do collision detection for each pair of colliders
-	for (int i = 0; i < ColliderObjectsList.size(); ++i)
+	for (ColliderPair & pair : CollisionPairList)
 	{
-		for (int j = 0; j < ColliderObjectsList.size(); ++j)
+		Collider * collider1 = pair.ColliderA;
+		Collider * collider2 = pair.ColliderB;
+
+		// Every candidate pair is cached, GJK keeps its warm start data there between steps
+		PairCache::CachedPair & cachedPair = CollisionPairCache.FindOrAdd(collider1->ColliderSlot, collider2->ColliderSlot, StepCount);
+
+		// Nearly stationary pairs keep last step's manifold, its points are moved with the shapes instead of running the narrowphase
+		ContactManifold * manifold = nullptr;
+		bool bIsColliding = false;
+		matrix4 relativeTransform;
+		bool bHasRelativeTransform = false;
+		// Neither body can have moved, the contacts found before they fell asleep are kept exactly as they were
+		bool bIsPairAsleep = IsColliderAtRest(collider1) && IsColliderAtRest(collider2);
+		if (bIsPairAsleep)
 		{
-			if( i == j )
-				break;
-			Collider * collider1 = ColliderObjectsList[i];
-			Collider * collider2 = ColliderObjectsList[j];
+			if (cachedPair.ManifoldID >= 0)
+				manifold = ManifoldObjectsList[cachedPair.ManifoldID];
+			bIsColliding = (manifold != nullptr) || (cachedPair.pConstraint != nullptr);
+		}
+		else if (bIsContactReuseEnabled && (cachedPair.Flags & PairCache::HAS_CONTACT_POSE) && cachedPair.ManifoldID >= 0)
+		{
+			++ContactReuseStats.CandidateCount;
+			relativeTransform = GetRelativeTransform(collider1, collider2);
+			bHasRelativeTransform = true;
+			vector3 scale1(glm::length(vector3(collider1->LocalToWorldMatrix[0])), glm::length(vector3(collider1->LocalToWorldMatrix[1])), glm::length(vector3(collider1->LocalToWorldMatrix[2])));
+			if (IsContactPoseReusable(cachedPair.ContactRelativeTransform, relativeTransform, scale1))
+			{
+				manifold = ManifoldObjectsList[cachedPair.ManifoldID];
+				// Also recomputes the depths along the cached normals
+				ManifoldStats.DroppedContactCount += manifold->ValidateAllContacts(collider1->LocalToWorldMatrix, collider2->LocalToWorldMatrix);
+				if (manifold->Size > 0)
+				{
+					bIsColliding = true;
+					++ContactReuseStats.HitCount;
+				}
+				else
+					manifold = nullptr;
+			}
+		}
 
-			Transform * transform1 = collider1->GetOwner()->GetComponent<Transform>();
-			Transform * transform2 = collider2->GetOwner()->GetComponent<Transform>();
+		// Shape pairs with a specialized kernel get a full manifold from it, anything else a single contact from GJK
+		NarrowphaseDispatch::Kernel kernel = bIsPairKernelDispatchEnabled ? NarrowphaseDispatch::FindKernel(collider1->eShapeType, collider2->eShapeType) : nullptr;
+		ContactManifold newManifold;
+		ContactData newContactData;
+		bool bShouldRunNarrowphase = (manifold == nullptr) && (bIsPairAsleep == false);
+		if (bShouldRunNarrowphase && kernel)
+		{
+			bIsColliding = kernel(*collider1, *collider2, newManifold);
+			++PairKernelStats.CallCount;
+			PairKernelStats.ContactCount += newManifold.Size;
+		}
+		else if (bShouldRunNarrowphase)
+		{
+			bIsColliding = (eNarrowphaseMode == SIGNED_VOLUMES) ?
+				SignedVolumesCollisionHandler(collider1, collider2, newContactData, &cachedPair) :
+				GJKCollisionHandler(collider1, collider2, newContactData, &cachedPair);
+		}
 
-			ContactData newContactData;
-			// Calculate the model matrices and store in contact data for future use
-			matrix4 model1, model2;
-			matrix4 translate = glm::translate(transform1->GetPosition());
-			matrix4 rotate = glm::mat4_cast(transform1->GetRotation());
-			matrix4 scale = glm::scale(transform1->GetScale());
-			model1 = translate * rotate * scale;
+		// Kernel pairs always use a manifold, GJK pairs collect their single contacts into one when manifolds are persistent
+		if (manifold == nullptr && bIsColliding && bIsPairAsleep == false && (kernel || bIsPersistentManifoldEnabled))
+		{
+			manifold = &AcquireManifold(cachedPair);
+			if (bIsPersistentManifoldEnabled)
+				ManifoldStats.DroppedContactCount += manifold->ValidateAllContacts(collider1->LocalToWorldMatrix, collider2->LocalToWorldMatrix);
+			else
+				manifold->Clear();
 
-			translate = glm::translate(transform2->GetPosition());
-			rotate = glm::mat4_cast(transform2->GetRotation());
-			scale = glm::scale(transform2->GetScale());
-			model2 = translate * rotate * scale;
+			if (kernel)
+				manifold->UpdateContacts(newManifold);
+			else
+				manifold->AddContact(newContactData);
+
+			for (int i = 0; i < manifold->Size; ++i)
+				ManifoldStats.PersistentContactCount += (manifold->ManifoldPoints[i].Lifetime > 0) ? 1 : 0;
+			ManifoldStats.ContactCount += manifold->Size;
 
-			collider1->LocalToWorldMatrix = model1;
-			collider2->LocalToWorldMatrix = model2;
+			// Later steps compare against the pose the narrowphase ran at, so slow drift can't build up unnoticed
+			cachedPair.ContactRelativeTransform = bHasRelativeTransform ? relativeTransform : GetRelativeTransform(collider1, collider2);
+			cachedPair.Flags |= PairCache::HAS_CONTACT_POSE;
 
-			// Set to Red if colliding, Green if not colliding
-			if (GJKCollisionHandler(collider1, collider2, newContactData))
+			// A single contact constraint left from before manifolds were turned on would be solved twice
+			if (cachedPair.pConstraint)
 			{
-				// Check if contact constraint between these two bodies already exists before adding another one
-				bool bAlreadyExists = false;
-				ContactConstraint * contactConstraint = nullptr;
+				UnregisterConstraintObject(cachedPair.pConstraint);
+				delete cachedPair.pConstraint;
+				cachedPair.pConstraint = nullptr;
+			}
+		}
 
-				for (Constraint * constraint : ConstraintObjectsList)
-				{
-					contactConstraint = dynamic_cast<ContactConstraint *>(constraint);
-					if (contactConstraint)
-					{
-						if (contactConstraint->ColliderA == collider1 && contactConstraint->ColliderB == collider2)
-						{
-							bAlreadyExists = true;
-							break;
-						}
-					}
-				}
+		// The manifold only lives as long as the shapes touch, its constraints go with it
+		if (cachedPair.ManifoldID >= 0 && manifold == nullptr)
+		{
+			ReleaseManifold(cachedPair.ManifoldID);
+			cachedPair.ManifoldID = -1;
+		}
+		if (manifold == nullptr)
+			cachedPair.Flags &= ~PairCache::HAS_CONTACT_POSE;
 
-				if (bAlreadyExists == false)
-				{
-					// Create a contact constraint between the two objects
-					ContactConstraint * newConstraint = new ContactConstraint(*collider1, *collider2);
-					newConstraint->ConstraintData = newContactData;
-					newConstraint->CalculateJacobian();
-
-					// Register it to be resolved later
-					RegisterConstraintObject(newConstraint);
-
-				//	// Create manifold that contains the new contact point
-				//	ContactManifold * newManifold = new ContactManifold();
-				//	newManifold->ConstraintID = newConstraint->ConstraintSlot;
-
-				//	// Register manifold to keep track of it later
-				//	RegisterManifoldObject(newManifold);
-				//	// Add new point to manifold
-				//	newManifold->Push(newContactData);
-				}
-				else
-				{
-					// If contact constraint (and therefore manifold) already exist, add new point to manifold 
-					//ContactManifold * manifold = ManifoldObjectsList[contactConstraint->ManifoldID];
-					//manifold->Push(newContactData);
+		// Set to Red if colliding
+		if (bIsColliding)
+		{
+			++collidingPairCount;
 
-					//// Create new constraint for new contact point
-					//ContactConstraint * newConstraint = new ContactConstraint(*collider1, *collider2);
-					//newConstraint->ConstraintData = newContactData;
-					//newConstraint->CalculateJacobian();
+			// An awake body touching a sleeping one wakes it, the rest of its island is woken by the solver
+			if (bIsPairAsleep == false)
+			{
+				Physics * physics1 = collider1->GetOwner()->GetComponent<Physics>();
+				Physics * physics2 = collider2->GetOwner()->GetComponent<Physics>();
+				if (physics1 && physics1->bIsAsleep)
+					physics1->WakeUp();
+				if (physics2 && physics2->bIsAsleep)
+					physics2->WakeUp();
+			}
 
-					//// Register it to be resolved later
-					//RegisterConstraintObject(newConstraint);
-				}
+			if (manifold)
+			{
+				// Every point of the manifold is solved by its own constraint
+				// Sleeping pairs leave theirs registered as they are, the solver skips sleeping islands
+				if (bIsPairAsleep == false)
+					UpdateManifoldConstraints(*manifold, collider1, collider2);
+			}
+			// Check if contact constraint between these two bodies already exists before adding another one
+			else if (cachedPair.pConstraint == nullptr)
+			{
+				// Create a contact constraint between the two objects
+				ContactConstraint * newConstraint = new ContactConstraint(*collider1, *collider2);
+				newConstraint->ConstraintData = newContactData;
 
-				Primitive * mesh1 = collider1->GetOwner()->GetComponent<Primitive>();
-				mesh1->SetVertexColorsUniform(vector3(1.0f, 0.0f, 0.0f));
+				// Register it to be resolved later
+				RegisterConstraintObject(newConstraint);
+				cachedPair.pConstraint = newConstraint;
+			}
 
-				Primitive * mesh2 = collider2->GetOwner()->GetComponent<Primitive>();
-				mesh2->SetVertexColorsUniform(vector3(1.0f, 0.0f, 0.0f));
+			Primitive * mesh1 = collider1->GetOwner()->GetComponent<Primitive>();
+			mesh1->SetVertexColorsUniform(vector3(1.0f, 0.0f, 0.0f));
 
-				glm::vec3 endPoint = newContactData.ContactPositionA_WS + newContactData.PenetrationDepth * glm::normalize(newContactData.Normal);
+			Primitive * mesh2 = collider2->GetOwner()->GetComponent<Primitive>();
+			mesh2->SetVertexColorsUniform(vector3(1.0f, 0.0f, 0.0f));
+
+			if (bIsStaticGeometryBuilt)
+			{
+				if (collider1->eColliderType == Collider::STATIC)
+					CollidingStaticColliderList.push_back(collider1);
+				if (collider2->eColliderType == Collider::STATIC)
+					CollidingStaticColliderList.push_back(collider2);
+			}
+
+			int contactCount = manifold ? manifold->Size : (bIsPairAsleep ? 0 : 1);
+			for (int i = 0; i < contactCount; ++i)
+			{
+				const ContactData & contact = manifold ? manifold->ManifoldPoints[i] : newContactData;
+				glm::vec3 endPoint = contact.ContactPositionA_WS + contact.PenetrationDepth * glm::normalize(contact.Normal);
 
 				// Render contact normal
-				Arrow newDebugArrow(glm::vec3(newContactData.ContactPositionA_WS), endPoint);
+				Arrow newDebugArrow(glm::vec3(contact.ContactPositionA_WS), endPoint);
 				//newDebugArrow.Scale = newContactData.PenetrationDepth;
 				EngineHandle.GetDebugFactory().RegisterDebugArrow(newDebugArrow);
 				// Render contact point
-				Quad newQuad(newContactData.ContactPositionA_WS);
+				Quad newQuad(contact.ContactPositionA_WS);
 				EngineHandle.GetDebugFactory().RegisterDebugQuad(newQuad);
 			}
-			else
-			{
-				Primitive * mesh1 = collider1->GetOwner()->GetComponent<Primitive>();
-				mesh1->SetVertexColorsUniform(vector3(0.0f, 1.0f, 0.0f));
+		}
+	}
+
+	BroadphaseStatistics & stats = BroadphaseStats[eBroadphaseMode];
+	stats.CandidatePairCount = (int)CollisionPairList.size();
+	stats.CollidingPairCount = collidingPairCount;
+	stats.BroadphaseTime = (float)(narrowphaseStartTime - broadphaseStartTime) * 1000.0f;
+	stats.NarrowphaseTime = (float)(glfwGetTime() - narrowphaseStartTime) * 1000.0f;
+}
+
+matrix4 PhysicsManager::GetRelativeTransform(Collider * aColliderA, Collider * aColliderB) const
+{
+	return glm::inverse(aColliderA->LocalToWorldMatrix) * aColliderB->LocalToWorldMatrix;
+}
+
+bool PhysicsManager::IsContactPoseReusable(const matrix4 & aPreviousTransform, const matrix4 & aCurrentTransform, const vector3 & aScaleA) const
+{
+	// The translations are in A's scaled local space, scaling the difference back gives its length in world units
+	vector3 translation = aScaleA * (vector3(aCurrentTransform[3]) - vector3(aPreviousTransform[3]));
+	if (glm::dot(translation, translation) > ContactReuseLinearThreshold * ContactReuseLinearThreshold)
+		return false;
+
+	// Angle of the rotation between the two poses from the trace of previous^T * current, trace = 1 + 2cos(angle)
+	// Columns are normalized first since the model matrices carry the scale of the transforms
+	float trace = 0.0f;
+	for (int i = 0; i < 3; ++i)
+		trace += glm::dot(glm::normalize(vector3(aPreviousTransform[i])), glm::normalize(vector3(aCurrentTransform[i])));
+	return 0.5f * (trace - 1.0f) >= cos(ContactReuseAngularThreshold);
+}
+
+void PhysicsManager::UpdateColliderBounds()
+{
+	// Static colliders had their bounds calculated once when the static geometry was built
+	for (Collider * collider : DynamicColliderList)
+	{
+		// Sleeping bodies keep the bounds they had when they fell asleep, unless their transform was edited since
+		Physics * physics = collider->GetOwner()->GetComponent<Physics>();
+		if (physics)
+		{
+			physics->WakeUpIfMoved();
+			if (physics->bIsAsleep)
+				continue;
+		}
+		UpdateColliderBounds(collider);
+	}
+}
+
+bool PhysicsManager::IsColliderAtRest(Collider * aCollider) const
+{
+	if (aCollider->eColliderType == Collider::STATIC)
+		return true;
+	Physics * physics = aCollider->GetOwner()->GetComponent<Physics>();
+	return physics && physics->bIsAsleep;
+}
+
+void PhysicsManager::UpdateColliderBounds(Collider * aCollider)
+{
+	Transform * transform = aCollider->GetOwner()->GetComponent<Transform>();
 
-				Primitive * mesh2 = collider2->GetOwner()->GetComponent<Primitive>();
-				mesh2->SetVertexColorsUniform(vector3(0.0f, 1.0f, 0.0f));
+	// Calculate the model matrix and store it for use by the broadphase and narrowphase
+	matrix4 translate = glm::translate(transform->GetPosition());
+	matrix4 rotate = glm::mat4_cast(transform->GetRotation());
+	matrix4 scale = glm::scale(transform->GetScale());
+	aCollider->LocalToWorldMatrix = translate * rotate * scale;
+	aCollider->WorldToLocalRotation = glm::transpose(matrix3(rotate));
+
+	aCollider->UpdateBoundingBox();
+}
+
+void PhysicsManager::FindCollisionPairs()
+{
+	CollisionPairList.clear();
+	switch (eBroadphaseMode)
+	{
+		case BRUTE_FORCE:
+		{
+			// Every pair is tested, regardless of how far apart they are
+			for (int i = 0; i < (int)ColliderObjectsList.size(); ++i)
+			{
+				for (int j = 0; j < i; ++j)
+				{
+					// Static colliders can never collide with each other
+					if (ColliderObjectsList[i]->eColliderType == Collider::STATIC && ColliderObjectsList[j]->eColliderType == Collider::STATIC)
+						continue;
+					CollisionPairList.emplace_back(ColliderObjectsList[j], ColliderObjectsList[i]);
+				}
 			}
+			// Static colliders are still in the collider list, so they have already been paired
+			return;
+		}
+		case SWEEP_AND_PRUNE:
+		{
+			SweepAndPruneBroadphase.Update();
+			SweepAndPruneBroadphase.FindOverlappingPairs(CollisionPairList);
+			break;
+		}
+		case DYNAMIC_AABB_TREE:
+		{
+			AABBTreeBroadphase.Update();
+			AABBTreeBroadphase.FindOverlappingPairs(CollisionPairList);
+			break;
+		}
+		case SPATIAL_HASH_GRID:
+		{
+			HashGridBroadphase.Update();
+			HashGridBroadphase.FindOverlappingPairs(CollisionPairList);
+			break;
+		}
+		default:
+			break;
+	}
+
+	FindStaticGeometryPairs();
+}
+
+void PhysicsManager::FindStaticGeometryPairs()
+{
+	for (Collider * collider : DynamicColliderList)
+	{
+		auto queryCallback = [&](Collider * aStaticCollider)
+		{
+			// Lower slot first, same as every other broadphase
+			if (collider->ColliderSlot < aStaticCollider->ColliderSlot)
+				CollisionPairList.emplace_back(collider, aStaticCollider);
+			else
+				CollisionPairList.emplace_back(aStaticCollider, collider);
+			return true;
+		};
+		StaticGeometry.Query(collider->BoundingBox, queryCallback);
+	}
+}
+
+void PhysicsManager::BuildStaticGeometry()
+{
+	std::vector<Collider *> staticColliderList;
+	DynamicColliderList.clear();
+	for (Collider * collider : ColliderObjectsList)
+	{
+		if (collider->eColliderType != Collider::STATIC)
+		{
+			DynamicColliderList.push_back(collider);
+			continue;
 		}
+
+		// Static colliders never move, their model matrix and bounds are only calculated this once
+		UpdateColliderBounds(collider);
+		staticColliderList.push_back(collider);
+
+		SweepAndPruneBroadphase.RemoveCollider(collider);
+		AABBTreeBroadphase.RemoveCollider(collider);
+		HashGridBroadphase.RemoveCollider(collider);
 	}
+
+	StaticGeometry.Build(staticColliderList);
+	bIsStaticGeometryBuilt = true;
+}
+
+bool PhysicsManager::SignedVolumesCollisionHandler(Collider * aCollider1, Collider * aCollider2, ContactData & aContactData, PairCache::CachedPair * aCachedPair)
+{
+	++SignedVolumesStats.CallCount;
+	// The full shapes decide whether the pair collides, the rounded cores would miss corners overlapping by less than the margins
+	SignedVolumesGJK::DistanceResult result = SignedVolumesNarrowphase.ComputeDistance(aCollider1, aCollider2, false);
+	SignedVolumesStats.IterationCount += result.IterationCount;
+	if (result.bIsIntersecting == false)
+		return false;
+
+	// Cores that are still apart give the contact normal directly, touching cores give no usable normal
+	result = SignedVolumesNarrowphase.ComputeDistance(aCollider1, aCollider2, true);
+	SignedVolumesStats.IterationCount += result.IterationCount;
+	if (result.bIsIntersecting == false && result.Distance > 1e-5f)
+	{
+		vector3 normal = (result.ClosestPointB - result.ClosestPointA) / result.Distance;
+		// Slide the core closest points along the normal onto the support planes of the full shapes, so corners keep their real depth
+		SupportPoint supportPoint = Utility::Support(aCollider1, aCollider2, normal, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
+		aContactData.ContactPositionA_WS = result.ClosestPointA + glm::dot(supportPoint.World_SupportPointA - result.ClosestPointA, normal) * normal;
+		aContactData.ContactPositionB_WS = result.ClosestPointB + glm::dot(supportPoint.World_SupportPointB - result.ClosestPointB, normal) * normal;
+		aContactData.ContactPositionA_LS = vector3(glm::inverse(aCollider1->LocalToWorldMatrix) * vector4(aContactData.ContactPositionA_WS, 1));
+		aContactData.ContactPositionB_LS = vector3(glm::inverse(aCollider2->LocalToWorldMatrix) * vector4(aContactData.ContactPositionB_WS, 1));
+		aContactData.Normal = normal;
+		aContactData.PenetrationDepth = glm::dot(aContactData.ContactPositionA_WS - aContactData.ContactPositionB_WS, normal);
+		++SignedVolumesStats.ShallowContactCount;
+		return true;
+	}
+
+	// Deep penetration, the closest points are no longer defined and the contact has to come from EPA
+	++SignedVolumesStats.EPAFallbackCount;
+	return GJKCollisionHandler(aCollider1, aCollider2, aContactData, aCachedPair);
 }
 
 // Casey Muratori explains it best: https://www.youtube.com/watch?v=Qupqu1xe7Io
-bool PhysicsManager::GJKCollisionHandler(Collider * aCollider1, Collider * aCollider2, ContactData & aContactData)
+bool PhysicsManager::GJKCollisionHandler(Collider * aCollider1, Collider * aCollider2, ContactData & aContactData, PairCache::CachedPair * aCachedPair)
 {
 	Physics * physics1 = aCollider1->GetOwner()->GetComponent<Physics>();
 	Physics * physics2 = aCollider2->GetOwner()->GetComponent<Physics>();
 
-	Simplex simplex;
-	// Choose initial search direction as some arbitrary vector
-	vector3 searchDirection = vector3(1, 1, 1);
-	// Find farthest point along search direction to get first point on the Minkowski surface, and add it to the simplex
-	SupportPoint newSupportPoint = Utility::Support(aCollider1, aCollider2, searchDirection, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
-	// Stability check
-	if (glm::dot(searchDirection, newSupportPoint.MinkowskiHullVertex) >= glm::length(newSupportPoint.MinkowskiHullVertex) * 0.8f)
+	++GJKStats.CallCount;
+	unsigned int warmStartFlags = 0;
+	if (aCachedPair)
 	{
-		// the chosen direction is invalid, will produce (0,0,0) for a subsequent direction later
-		searchDirection = vector3(0, 1, 0);
-		newSupportPoint = Utility::Support(aCollider1, aCollider2, searchDirection, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
+		if (bIsGJKWarmStartEnabled)
+			warmStartFlags = aCachedPair->Flags;
+		// Warm start data is rewritten every time GJK finishes, if it fails to finish there is nothing worth keeping
+		aCachedPair->Flags &= ~(PairCache::HAS_SEPARATING_AXIS | PairCache::HAS_SIMPLEX);
 	}
-	simplex.Push(newSupportPoint);
 
-	// Invert the search direction for the next point
-	searchDirection *= -1.0f;
-
-	const unsigned iterationLimit = 75;
-	unsigned iterationCount = 0;
+	Simplex simplex;
+	vector3 searchDirection;
+	bool bContainsOrigin = false;
 
-	while (true)
+	if (warmStartFlags & PairCache::HAS_SIMPLEX)
 	{
-		if (iterationCount++ >= iterationLimit) 
-			return false;
-		// Stability check
-		// Error, for some reason the direction vector is broken
-		if (glm::length(searchDirection) <= 0.0001f)
-			return false;
-
-		// Add a new point to the simplex
-		SupportPoint newSupportPoint = Utility::Support(aCollider1, aCollider2, searchDirection, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
-		simplex.Push(newSupportPoint);
+		// The pair was touching last step, rebuild its last simplex for the current positions
+		// If it still contains the origin there is nothing left for GJK to do
+		++GJKStats.IterationCount;
+		for (int i = 0; i < 4; ++i)
+			simplex.Vertices[i] = Utility::SupportFromLocalPoints(aCachedPair->LocalSimplexPointsA[i], aCachedPair->LocalSimplexPointsB[i], aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
+		simplex.Size = 4;
+
+		bContainsOrigin = Utility::IsOriginInsideTetrahedron(simplex);
+		if (bContainsOrigin)
+			++GJKStats.WarmStartHitCount;
+		else
+			simplex.Clear();
+	}
 
-		// If projection of newly added point along the search direction has not crossed the origin,
-		// the Minkowski Difference could not contain the origin, objects are not colliding
-		if (glm::dot(newSupportPoint.MinkowskiHullVertex, searchDirection) < 0.0f)
+	if (bContainsOrigin == false)
+	{
+		SupportPoint newSupportPoint;
+		if (warmStartFlags & PairCache::HAS_SEPARATING_AXIS)
 		{
-			return false;
+			// The pair was separated last step, the same axis most likely still separates it
+			searchDirection = aCachedPair->SeparatingAxis;
+			newSupportPoint = Utility::Support(aCollider1, aCollider2, searchDirection, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
+			++GJKStats.IterationCount;
+			if (glm::dot(newSupportPoint.MinkowskiHullVertex, searchDirection) < 0.0f)
+			{
+				++GJKStats.WarmStartHitCount;
+				aCachedPair->Flags |= PairCache::HAS_SEPARATING_AXIS;
+				return false;
+			}
+			simplex.Push(newSupportPoint);
+			// Search back towards the origin from the new point
+			searchDirection = -newSupportPoint.MinkowskiHullVertex;
 		}
 		else
 		{
-			// Render simplex
- 			if (EngineHandle.GetEngineStateManager().bShouldRenderSimplex)
- 			{
- 				LineLoop simplexDebug;
- 				for(int i = 0; i < simplex.Size; ++i)
- 					simplexDebug.AddVertex(simplex.Vertices[i].MinkowskiHullVertex);
- 
- 				EngineHandle.GetDebugFactory().RegisterDebugLineLoop(simplexDebug);
- 			}
-			// If the new point IS past the origin, check if the simplex contains the origin, 
-			// If it doesn't modify search direction to point towards to origin
-			if (CheckIfSimplexContainsOrigin(simplex, searchDirection))
+			// Choose initial search direction as some arbitrary vector
+			searchDirection = vector3(1, 1, 1);
+			// Find farthest point along search direction to get first point on the Minkowski surface, and add it to the simplex
+			newSupportPoint = Utility::Support(aCollider1, aCollider2, searchDirection, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
+			++GJKStats.IterationCount;
+			// Stability check
+			if (glm::dot(searchDirection, newSupportPoint.MinkowskiHullVertex) >= glm::length(newSupportPoint.MinkowskiHullVertex) * 0.8f)
 			{
-				// Stops the simulation every time there is a contact if 'contact debug mode' is enabled
-				if(EngineHandle.GetEngineStateManager().bContactDebugModeEnabled == true)
-					EngineHandle.GetEngineStateManager().bShouldSimulationRun = false;
-				// Continues the simulation if currently stopped
-				if (EngineHandle.GetInputManager().isKeyPressed(GLFW_KEY_LEFT_ALT))
-					EngineHandle.GetEngineStateManager().bShouldSimulationRun = true;
+				// the chosen direction is invalid, will produce (0,0,0) for a subsequent direction later
+				searchDirection = vector3(0, 1, 0);
+				newSupportPoint = Utility::Support(aCollider1, aCollider2, searchDirection, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
+			}
+			simplex.Push(newSupportPoint);
+
+			// Invert the search direction for the next point
+			searchDirection *= -1.0f;
+		}
+
+		const unsigned iterationLimit = 75;
+		unsigned iterationCount = 0;
+
+		while (bContainsOrigin == false)
+		{
+			if (iterationCount++ >= iterationLimit) 
+				return false;
+			// Stability check
+			// Error, for some reason the direction vector is broken
+			if (glm::length(searchDirection) <= 0.0001f)
+				return false;
+
+			// Add a new point to the simplex
+			newSupportPoint = Utility::Support(aCollider1, aCollider2, searchDirection, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
+			++GJKStats.IterationCount;
+			simplex.Push(newSupportPoint);
 
-				// Run contact detection when collision is detected
-				return EPAContactDetection(simplex, aCollider1, aCollider2, aContactData);
+			// If projection of newly added point along the search direction has not crossed the origin,
+			// the Minkowski Difference could not contain the origin, objects are not colliding
+			if (glm::dot(newSupportPoint.MinkowskiHullVertex, searchDirection) < 0.0f)
+			{
+				// This direction is a separating axis, try it first next step
+				if (aCachedPair)
+				{
+					aCachedPair->SeparatingAxis = searchDirection;
+					aCachedPair->Flags |= PairCache::HAS_SEPARATING_AXIS;
+				}
+				return false;
 			}
+			else
+			{
+				// Render simplex
+ 				if (EngineHandle.GetEngineStateManager().bShouldRenderSimplex)
+ 				{
+ 					LineLoop simplexDebug;
+ 					for(int i = 0; i < simplex.Size; ++i)
+ 						simplexDebug.AddVertex(simplex.Vertices[i].MinkowskiHullVertex);
+ 
+ 					EngineHandle.GetDebugFactory().RegisterDebugLineLoop(simplexDebug);
+ 				}
+				// If the new point IS past the origin, check if the simplex contains the origin, 
+				// If it doesn't modify search direction to point towards to origin
+				bContainsOrigin = CheckIfSimplexContainsOrigin(simplex, searchDirection);
+			}
+		}
+	}
+
+	// Keep the simplex so it can be rebuilt next step
+	if (aCachedPair)
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			aCachedPair->LocalSimplexPointsA[i] = simplex.Vertices[i].Local_SupportPointA;
+			aCachedPair->LocalSimplexPointsB[i] = simplex.Vertices[i].Local_SupportPointB;
 		}
+		aCachedPair->Flags |= PairCache::HAS_SIMPLEX;
 	}
+
+	// Stops the simulation every time there is a contact if 'contact debug mode' is enabled
+	if(EngineHandle.GetEngineStateManager().bContactDebugModeEnabled == true)
+		EngineHandle.GetEngineStateManager().bShouldSimulationRun = false;
+	// Continues the simulation if currently stopped
+	if (EngineHandle.GetInputManager().isKeyPressed(GLFW_KEY_LEFT_ALT))
+		EngineHandle.GetEngineStateManager().bShouldSimulationRun = true;
+
+	// Run contact detection when collision is detected
+	return EPAContactDetection(simplex, aCollider1, aCollider2, aContactData);
 }
 
 // Provides the new direction to search for the point if it isn't already within the simplex
@@ -447,198 +813,768 @@ bool PhysicsManager::CheckIfSimplexContainsOrigin(Simplex & aSimplex, vector3 &
 
 void PhysicsManager::SolveConstraints()
 {
+	IslandStats = IslandStatistics();
+	SleepStats = SleepStatistics();
+	// Islands share no dynamic bodies, so each is solved on its own and they can run on different threads
+	// Built even without constraints, UpdateSleep groups the bodies with them
+	Islands.Build((int)ColliderObjectsList.size(), ConstraintObjectsList);
 	// Skip solver if no constraints
 	if (ConstraintObjectsList.size() == 0)
 		return;
-	// TODO : [@Derek] - Figure out a better name for the temporary vectors
-	std::vector<Eigen::Matrix<float, 6 , 1>> catto_A;
-	catto_A.reserve(ColliderObjectsList.size());
 
-	// Initialize one entry per collider
-	for (int i = 0; i < ColliderObjectsList.size(); ++i)
+	double solveStartTime = glfwGetTime();
+	int islandCount = Islands.GetIslandCount();
+	int constraintCount = Islands.GetConstraintCount();
+
+	// Set by the island owning the constraint, the constraints are only discarded once every island is done
+	std::vector<char> discardFlags(constraintCount, 0);
+	std::vector<int> iterationCounts(islandCount, 0);
+	// Of the last iteration of each island
+	std::vector<SolverResidual> residuals(islandCount);
+
+	// Islands whose bodies are all asleep are skipped, an island with both sleeping and awake bodies has been touched and wakes up
+	std::vector<int> islandOrder;
+	islandOrder.reserve(islandCount);
+	for (int i = 0; i < islandCount; ++i)
 	{
-		catto_A.push_back(Eigen::Matrix<float, 6, 1>());
-		catto_A.back().setZero();
+		if (WakeUpIsland(Islands.GetIsland(i)))
+			islandOrder.push_back(i);
+		else
+			++SleepStats.SleepingIslandCount;
 	}
-	// Calculate preliminary values of Catto_A - it is used to store already calculated impulses
-	for (int i = 0; i < ConstraintObjectsList.size(); ++i)
+	int activeIslandCount = (int)islandOrder.size();
+
+	// Body prestep, every awake body gets a solver body with its world inverse inertia computed once for the whole step
+	// Static bodies, and colliders without a physics component, share the solver body that never moves
+	SolverBodies.Clear();
+	SolverBodyIndexList.assign(ColliderObjectsList.size(), SolverBodyList::StaticBody);
+	for (Collider * collider : DynamicColliderList)
 	{
-		Constraint * constraint = nullptr;
-		constraint = ConstraintObjectsList[i];
+		Physics * physics = collider->GetOwner()->GetComponent<Physics>();
+		if (physics == nullptr || collider->eColliderType == Collider::STATIC || physics->bIsAsleep)
+			continue;
+		// Convert the inverse inertia tensor from local space to world space using the 3x3 submatrix of the Rotation transform
+		// InertiaTensor is per unit mass, so the inverse is scaled by the inverse mass for both the effective mass and the impulses
+		matrix3 rotationMatrix = glm::mat3_cast(collider->GetOwner()->GetComponent<Transform>()->Rotation);
+		matrix3 inverseInertiaTensor = physics->InverseMass * (rotationMatrix * glm::inverse(collider->InertiaTensor) * glm::transpose(rotationMatrix));
+		SolverBodyIndexList[collider->ColliderSlot] = SolverBodies.Add(*physics, inverseInertiaTensor);
+	}
+	// Indexed like the island constraint list, so each island's rows are contiguous
+	ConstraintRowList.resize(constraintCount);
+	FrictionRowList.resize(ConstraintRow::FrictionRowCount * constraintCount);
 
-		if (constraint)
+	// Largest islands first so that a big pile isn't picked up last by a thread while the others sit idle
+	std::sort(islandOrder.begin(), islandOrder.end(), [this](int aIslandA, int aIslandB)
+	{
+		return Islands.GetIsland(aIslandA).ConstraintCount > Islands.GetIsland(aIslandB).ConstraintCount;
+	});
+
+	float deltaTime = EngineHandle.GetFramerateController().DeltaTime;
+	int hardwareThreadCount = bIsIslandSolverMultithreaded ? std::max(1, (int)std::thread::hardware_concurrency()) : 1;
+	if ((int)SolverScratchList.size() < hardwareThreadCount)
+		SolverScratchList.resize(hardwareThreadCount);
+	// Only read by the threads
+	IslandStats.InstructionSet = std::min(eSolverInstructionSet, SIMD::GetSupportedInstructionSet());
+	// Indexed by island, 0 for the islands that weren't colored
+	std::vector<int> colorCounts(islandCount, 0);
+	std::vector<int> batchCounts(islandCount, 0);
+	std::vector<int> blockCounts(islandCount, 0);
+	// Every island puts back the entries of its manifolds, only the new slots need to be cleared
+	ManifoldBlockList.resize(ManifoldObjectsList.size(), -1);
+
+	// Islands big enough to keep several threads busy are colored and solved one at a time by all of them, largest first
+	// A single pile would otherwise leave every thread but one idle
+	int firstUncoloredIsland = 0;
+	if (bIsGraphColoringEnabled)
+	{
+		for (; firstUncoloredIsland < activeIslandCount; ++firstUncoloredIsland)
 		{
-			// Set lambda to its initial value
-			constraint->ImpulseMagnitude = constraint->InitialLambda;
+			int island = islandOrder[firstUncoloredIsland];
+			int islandThreadCount = std::min(hardwareThreadCount, Islands.GetIsland(island).ConstraintCount / std::max(1, MinConstraintsPerThread));
+			if (islandThreadCount < 2)
+				break;
+			IslandSolverScratch & scratch = SolverScratchList[0];
+			iterationCounts[island] = SolveColoredIsland(Islands.GetIsland(island), &discardFlags[0], deltaTime, islandThreadCount, scratch, residuals[island]);
+			colorCounts[island] = scratch.Coloring.GetColorCount();
+			batchCounts[island] = (int)scratch.BatchList.size();
+			blockCounts[island] = (int)scratch.BlockList.size();
+			IslandStats.ThreadCount = std::max(IslandStats.ThreadCount, islandThreadCount);
+		}
+	}
 
-			// Per constraint, the first non-static body is used to calculate the catto_A vector for that body
-			if (constraint->ColliderA->eColliderType > 0)
+	// The rest go one island per thread, those with enough constraints to fill batches are colored for the wide solver
+	std::atomic<int> nextIsland(firstUncoloredIsland);
+	auto solveIslands = [&](int aThread)
+	{
+		for (int i = nextIsland++; i < activeIslandCount; i = nextIsland++)
+		{
+			int island = islandOrder[i];
+			const SimulationIslands::Island & solvedIsland = Islands.GetIsland(island);
+			IslandSolverScratch & scratch = SolverScratchList[aThread];
+			if (bIsBatchSolverEnabled && solvedIsland.ConstraintCount >= MinBatchedConstraintCount)
 			{
-				catto_A[constraint->ColliderA->ColliderSlot] += constraint->ColliderA->InverseMassMatrix * constraint->ColliderA->ContactJacobian.transpose() * constraint->ImpulseMagnitude;
+				iterationCounts[island] = SolveColoredIsland(solvedIsland, &discardFlags[0], deltaTime, 1, scratch, residuals[island]);
+				colorCounts[island] = scratch.Coloring.GetColorCount();
+				batchCounts[island] = (int)scratch.BatchList.size();
 			}
 			else
-			{
-				catto_A[constraint->ColliderB->ColliderSlot] += constraint->ColliderB->InverseMassMatrix * constraint->ColliderB->ContactJacobian.transpose() * constraint->ImpulseMagnitude;
-			}
+				iterationCounts[island] = SolveIsland(solvedIsland, &discardFlags[0], deltaTime, scratch, residuals[island]);
+			blockCounts[island] = (int)scratch.BlockList.size();
+		}
+	};
+
+	int uncoloredConstraintCount = 0;
+	for (int i = firstUncoloredIsland; i < activeIslandCount; ++i)
+		uncoloredConstraintCount += Islands.GetIsland(islandOrder[i]).ConstraintCount;
+	int threadCount = std::max(1, std::min(std::min(hardwareThreadCount, activeIslandCount - firstUncoloredIsland), uncoloredConstraintCount / std::max(1, MinConstraintsPerThread)));
+	// The calling thread solves islands too
+	SolverThreads.Run(threadCount, solveIslands);
+	SolverBodies.WriteBack();
+
+	IslandStats.SolveTime = (float)(glfwGetTime() - solveStartTime) * 1000.0f;
+	IslandStats.IslandCount = activeIslandCount;
+	IslandStats.ThreadCount = std::max(IslandStats.ThreadCount, threadCount);
+	for (int island : islandOrder)
+	{
+		IslandStats.LargestIslandSize = std::max(IslandStats.LargestIslandSize, Islands.GetIsland(island).ConstraintCount);
+		IslandStats.IterationCount += iterationCounts[island];
+		IslandStats.MaxIterationCount = std::max(IslandStats.MaxIterationCount, iterationCounts[island]);
+		IslandStats.MaxRelativeResidual = std::max(IslandStats.MaxRelativeResidual, residuals[island].GetRelative());
+		if (colorCounts[island] > 0)
+			++IslandStats.ColoredIslandCount;
+		IslandStats.ColorCount = std::max(IslandStats.ColorCount, colorCounts[island]);
+		IslandStats.BatchCount += batchCounts[island];
+		IslandStats.BlockCount += blockCounts[island];
+		const SimulationIslands::Island & solvedIsland = Islands.GetIsland(island);
+		for (int i = solvedIsland.FirstConstraint; i < solvedIsland.FirstConstraint + solvedIsland.ConstraintCount; ++i)
+		{
+			if (GetFrictionRows(i)[0].FrictionCoefficient != 0.0f)
+				IslandStats.FrictionRowCount += ConstraintRow::FrictionRowCount;
 		}
 	}
+
+	// Remove the constraints that fell below threshold
+	for (int i = 0; i < constraintCount; ++i)
+	{
+		if (discardFlags[i] == 0)
+			continue;
+		Constraint * constraint = Islands.GetConstraint(i);
+		// The pair cache must not hand out a constraint that is no longer being solved
+		PairCache::CachedPair * cachedPair = CollisionPairCache.Find(constraint->ColliderA->ColliderSlot, constraint->ColliderB->ColliderSlot);
+		if (cachedPair && cachedPair->pConstraint == constraint)
+			cachedPair->pConstraint = nullptr;
+		UnregisterConstraintObject(constraint);
+		delete constraint;
+	}
+
+	// Manifold constraints are never discarded, their accumulated impulses follow the points to the next step
+	for (ContactManifold * manifold : ManifoldObjectsList)
+		manifold->StoreImpulses();
+}
+
+int PhysicsManager::SolveIsland(const SimulationIslands::Island & aIsland, char * aDiscardFlags, float aDeltaTime, IslandSolverScratch & aScratch, SolverResidual & aResidual)
+{
+	int begin = aIsland.FirstConstraint;
+	int end = aIsland.FirstConstraint + aIsland.ConstraintCount;
+	for (int i = begin; i < end; ++i)
+		SetRowBodies(i);
+	BuildSolveItems(aIsland, aScratch);
+
+	// Constraint prestep, the rows hold everything the iterations need so the constraints aren't touched again until the end
+	for (int i = begin; i < end; ++i)
+		PreStepRow(i, aDeltaTime, aScratch);
+	for (ContactBlock & block : aScratch.BlockList)
+	{
+		block.PreStep(ConstraintRowList, BlockSolverMaxConditionNumber);
+		if (bIsFrictionEnabled && bIsFrictionAnchorEnabled)
+			PreStepFrictionAnchor(block);
+	}
+	for (int i = begin; i < end; ++i)
+		WarmStartRow(i, aDeltaTime);
+
 	// Refine the Lagrangian multiplier 'λ' using Gauss-Siedel solver
+	int iterationCount = ConstraintSolverIterations;
 	for (int iterations = 0; iterations < ConstraintSolverIterations; ++iterations)
 	{
-		// When all constraints are solved, return
-		if (ConstraintObjectsList.size() == 0)
-			return;
-		int size = (int)ConstraintObjectsList.size();
-		for (int i = 0; i < ConstraintObjectsList.size(); ++i)
+		aResidual = SolverResidual();
+		for (int row : aScratch.SolveItemList)
+			aResidual.Add(SolveItem(row, aDiscardFlags, aDeltaTime, aScratch));
+
+		// Early exit once the island has converged, every constraint is either discarded or barely changing
+		if (HasIslandConverged(aResidual, iterations + 1))
 		{
-			Constraint * constraint = nullptr;
-			constraint = ConstraintObjectsList[i];
-			float deltaLambda = 0.0f;
-			float deltaTime = EngineHandle.GetFramerateController().DeltaTime;
+			iterationCount = iterations + 1;
+			break;
+		}
+	}
 
-			if (constraint)
-			{
-				Physics & physicsA = *constraint->ColliderA->pOwner->GetComponent<Physics>();
-				Physics & physicsB = *constraint->ColliderB->pOwner->GetComponent<Physics>();
-				
-				// Putting the bodies quantities in a matrix form like this allows for a convenient transformation when multiplied by inverse mass matrix
-				// Each quantity is multiplied against the value that corresponds to it (Inertia/angular velocity/torque and Mass/linear velocity/force)
-				// V2
-				Eigen::Matrix<float, 12, 1> currentVelocityVector; // Column vector
-				currentVelocityVector << physicsA.CurrentLinearVelocity.x, physicsA.CurrentLinearVelocity.y, physicsA.CurrentLinearVelocity.z,
-								  physicsA.CurrentAngularVelocity.x, physicsA.CurrentAngularVelocity.y, physicsA.CurrentAngularVelocity.z,
-								  physicsB.CurrentLinearVelocity.x, physicsB.CurrentLinearVelocity.y, physicsB.CurrentLinearVelocity.z,
-								  physicsB.CurrentAngularVelocity.x, physicsB.CurrentAngularVelocity.y, physicsB.CurrentAngularVelocity.z;
-				
-				// Fext
-				Eigen::Matrix<float, 12, 1> externalForceVector; // Column vector
-				externalForceVector << physicsA.Force.x, physicsA.Force.y, physicsA.Force.z,
-									   physicsA.Torque.x, physicsA.Torque.y, physicsA.Torque.z,
-									   physicsB.Force.x, physicsB.Force.y, physicsB.Force.z,
-									   physicsB.Torque.x, physicsB.Torque.y, physicsB.Torque.z;
-
-				// Each type of constraint calls its own solver
-				deltaLambda = constraint->Solve(deltaTime, catto_A, currentVelocityVector, externalForceVector);
-
-				// Remove this constraint if it falls below threshold
-				if (abs(deltaLambda) < 0.0000000001f)
-				{
-					std::cout << "Discarding constraint! \n";
-					std::swap(ConstraintObjectsList[i], ConstraintObjectsList.back());
-					ConstraintObjectsList.pop_back();
-					break;
-				}
+	for (int i = begin; i < end; ++i)
+	{
+		Islands.GetConstraint(i)->PostStep(ConstraintRowList[i]);
+		Islands.GetConstraint(i)->PostStepFriction(GetFrictionRows(i));
+	}
+	return iterationCount;
+}
 
-				// Get force of constraint for each body using the Lagrangian multiplier for magnitude and corresponding Jacobian for direction
-				Eigen::Matrix<float, 6, 1> constraintForceA = constraint->ColliderA->ContactJacobian.transpose() * deltaLambda * deltaTime;
-				Eigen::Matrix<float, 6, 1> constraintForceB = constraint->ColliderB->ContactJacobian.transpose() * deltaLambda * deltaTime;
+int PhysicsManager::SolveColoredIsland(const SimulationIslands::Island & aIsland, char * aDiscardFlags, float aDeltaTime, int aThreadCount, IslandSolverScratch & aScratch, SolverResidual & aResidual)
+{
+	int begin = aIsland.FirstConstraint;
+	int end = aIsland.FirstConstraint + aIsland.ConstraintCount;
+	for (int i = begin; i < end; ++i)
+		SetRowBodies(i);
+	BuildSolveItems(aIsland, aScratch);
+	// A block is colored as one item through its first row, every row of it is between the same bodies
+	ConstraintGraphColoring & coloring = aScratch.Coloring;
+	coloring.Build(ConstraintRowList, aScratch.SolveItemList, SolverBodies.GetCount());
+	int colorCount = coloring.GetColorCount();
+	int blockCount = (int)aScratch.BlockList.size();
+
+	// The rows solved alone come before the blocks in each color, coloring keeps the order of the items
+	std::vector<int> & colorBlockStartList = aScratch.ColorBlockStartList;
+	colorBlockStartList.resize(colorCount);
+	for (int color = 0; color < colorCount; ++color)
+	{
+		int first = coloring.GetColorBegin(color);
+		while (first < coloring.GetColorEnd(color) && aScratch.RowBlockList[coloring.GetRow(first) - begin] < 0)
+			++first;
+		colorBlockStartList[color] = first;
+	}
 
- 				vector3 forceA(constraintForceA(0), constraintForceA(1), constraintForceA(2)), torqueA(constraintForceA(3), constraintForceA(4), constraintForceA(5));
-				vector3 forceB(constraintForceB(0), constraintForceB(1), constraintForceB(2)), torqueB(constraintForceB(3), constraintForceB(4), constraintForceB(5));
+	// The rows of each color solved alone are cut into batches for the wide solver, except in the serial color whose rows may share bodies
+	bool bIsBatched = bIsBatchSolverEnabled;
+	std::vector<int> & colorBatchStartList = aScratch.ColorBatchStartList;
+	colorBatchStartList.assign(colorCount + 1, 0);
+	for (int color = 0; color < colorCount && bIsBatched; ++color)
+	{
+		int colorSize = coloring.IsSerialColor(color) ? 0 : colorBlockStartList[color] - coloring.GetColorBegin(color);
+		colorBatchStartList[color + 1] = colorBatchStartList[color] + (colorSize + ConstraintRowBatch::LaneCount - 1) / ConstraintRowBatch::LaneCount;
+	}
+	int batchCount = colorBatchStartList[colorCount];
+	aScratch.BatchList.resize(batchCount);
+	aScratch.FrictionBatchList.resize(ConstraintRow::FrictionRowCount * batchCount);
+	bool bHasFrictionAnchors = bIsFrictionEnabled && bIsFrictionAnchorEnabled && blockCount > 0;
+
+	ThreadBarrier barrier(aThreadCount);
+	// What each thread saw in the current iteration, every thread reduces them to the same residual
+	std::vector<SolverResidual> residualList(aThreadCount);
+	int iterationCount = ConstraintSolverIterations;
+
+	// Every thread gets the same fixed slice of each color, the rows of a color don't share a dynamic body so
+	// the order they're solved in within the color doesn't change the result, only the coloring does
+	auto solveSlices = [&](int aThread)
+	{
+		auto sliceBegin = [&](int aBegin, int aEnd, int aSlice) { return aBegin + (int)((long long)(aEnd - aBegin) * aSlice / aThreadCount); };
 
-				// Zero out forces if either object is static
-				if (constraint->ColliderA->eColliderType == Collider::STATIC)
+		// Constraint prestep only reads the bodies
+		for (int i = sliceBegin(begin, end, aThread); i < sliceBegin(begin, end, aThread + 1); ++i)
+			PreStepRow(i, aDeltaTime, aScratch);
+		barrier.Wait();
+
+		for (int block = sliceBegin(0, blockCount, aThread); block < sliceBegin(0, blockCount, aThread + 1); ++block)
+		{
+			aScratch.BlockList[block].PreStep(ConstraintRowList, BlockSolverMaxConditionNumber);
+			if (bHasFrictionAnchors)
+				PreStepFrictionAnchor(aScratch.BlockList[block]);
+		}
+
+		// Batches are packed from the prestepped rows, the lanes of a batch are consecutive rows of its color
+		for (int batch = sliceBegin(0, batchCount, aThread); batch < sliceBegin(0, batchCount, aThread + 1); ++batch)
+		{
+			int color = (int)(std::upper_bound(colorBatchStartList.begin(), colorBatchStartList.end(), batch) - colorBatchStartList.begin()) - 1;
+			int first = coloring.GetColorBegin(color) + (batch - colorBatchStartList[color]) * ConstraintRowBatch::LaneCount;
+			int last = std::min(first + ConstraintRowBatch::LaneCount, colorBlockStartList[color]);
+			ConstraintRowBatch & rowBatch = aScratch.BatchList[batch];
+			ConstraintRowBatch * frictionBatches = &aScratch.FrictionBatchList[ConstraintRow::FrictionRowCount * batch];
+			rowBatch.Clear();
+			for (int t = 0; t < ConstraintRow::FrictionRowCount; ++t)
+				frictionBatches[t].Clear();
+			for (int i = first; i < last; ++i)
+			{
+				int row = coloring.GetRow(i);
+				rowBatch.Set(i - first, ConstraintRowList[row], row, Islands.GetConstraint(row)->bIsDiscardable);
+				// Friction lanes line up with the lane of their row, they share its bodies so don't conflict with the other lanes either
+				const ConstraintRow * frictionRows = GetFrictionRows(row);
+				if (frictionRows[0].FrictionCoefficient == 0.0f)
+					continue;
+				for (int t = 0; t < ConstraintRow::FrictionRowCount; ++t)
+					frictionBatches[t].Set(i - first, frictionRows[t], ConstraintRow::FrictionRowCount * row + t, false);
+			}
+		}
+		// The anchors are warm started by other threads than the ones that filled them
+		if (bHasFrictionAnchors)
+			barrier.Wait();
+
+		// Warm start writes the velocities, so it goes color by color like the iterations
+		// No barrier needed after packing, it only changes the velocities and the batches only copied the rows
+		for (int color = 0; color < colorCount; ++color)
+		{
+			bool bIsSerial = coloring.IsSerialColor(color);
+			if (bIsSerial == false || aThread == 0)
+			{
+				int colorBegin = coloring.GetColorBegin(color);
+				int colorEnd = coloring.GetColorEnd(color);
+				int first = bIsSerial ? colorBegin : sliceBegin(colorBegin, colorEnd, aThread);
+				int last = bIsSerial ? colorEnd : sliceBegin(colorBegin, colorEnd, aThread + 1);
+				for (int i = first; i < last; ++i)
+					WarmStartItem(coloring.GetRow(i), aDeltaTime, aScratch);
+			}
+			barrier.Wait();
+		}
+
+		for (int iterations = 0; iterations < ConstraintSolverIterations; ++iterations)
+		{
+			SolverResidual residual;
+			for (int color = 0; color < colorCount; ++color)
+			{
+				bool bIsSerial = coloring.IsSerialColor(color);
+				if (bIsBatched && bIsSerial == false)
 				{
-					forceA *= 0;
-					torqueA *= 0;
+					int batchBegin = colorBatchStartList[color];
+					int batchEnd = colorBatchStartList[color + 1];
+					for (int batch = sliceBegin(batchBegin, batchEnd, aThread); batch < sliceBegin(batchBegin, batchEnd, aThread + 1); ++batch)
+						residual.Add(SolveBatchWithFriction(batch, aDeltaTime, aScratch));
+					int blockBegin = colorBlockStartList[color];
+					int blockEnd = coloring.GetColorEnd(color);
+					for (int i = sliceBegin(blockBegin, blockEnd, aThread); i < sliceBegin(blockBegin, blockEnd, aThread + 1); ++i)
+						residual.Add(SolveItem(coloring.GetRow(i), aDiscardFlags, aDeltaTime, aScratch));
 				}
-				else if (constraint->ColliderB->eColliderType == Collider::STATIC)
+				else if (bIsSerial == false || aThread == 0)
 				{
-					forceB *= 0;
-					torqueB *= 0;
+					int colorBegin = coloring.GetColorBegin(color);
+					int colorEnd = coloring.GetColorEnd(color);
+					int first = bIsSerial ? colorBegin : sliceBegin(colorBegin, colorEnd, aThread);
+					int last = bIsSerial ? colorEnd : sliceBegin(colorBegin, colorEnd, aThread + 1);
+					for (int i = first; i < last; ++i)
+						residual.Add(SolveItem(coloring.GetRow(i), aDiscardFlags, aDeltaTime, aScratch));
 				}
+				barrier.Wait();
+			}
+			residualList[aThread] = residual;
+			barrier.Wait();
+
+			// The list isn't written again before the first color of the next iteration is done, so every thread reads the same values
+			SolverResidual islandResidual;
+			for (const SolverResidual & threadResidual : residualList)
+				islandResidual.Add(threadResidual);
+			if (aThread == 0)
+				aResidual = islandResidual;
+			if (HasIslandConverged(islandResidual, iterations + 1))
+			{
+				if (aThread == 0)
+					iterationCount = iterations + 1;
+				break;
+			}
+		}
+
+		// The batches hold the solved impulses, lanes that stopped being solved belong to constraints to discard
+		for (int batch = sliceBegin(0, batchCount, aThread); batch < sliceBegin(0, batchCount, aThread + 1); ++batch)
+		{
+			const ConstraintRowBatch & rowBatch = aScratch.BatchList[batch];
+			for (int lane = 0; lane < ConstraintRowBatch::LaneCount && rowBatch.Row[lane] >= 0; ++lane)
+			{
+				ConstraintRowList[rowBatch.Row[lane]].ImpulseSum = rowBatch.ImpulseSum[lane];
+				if ((rowBatch.ActiveMask & (1 << lane)) == 0)
+					aDiscardFlags[rowBatch.Row[lane]] = 1;
+			}
+			for (int t = 0; t < ConstraintRow::FrictionRowCount; ++t)
+			{
+				const ConstraintRowBatch & frictionBatch = aScratch.FrictionBatchList[ConstraintRow::FrictionRowCount * batch + t];
+				for (int lane = 0; lane < ConstraintRowBatch::LaneCount; ++lane)
+				{
+					if (frictionBatch.Row[lane] >= 0)
+						FrictionRowList[frictionBatch.Row[lane]].ImpulseSum = frictionBatch.ImpulseSum[lane];
+				}
+			}
+		}
+		barrier.Wait();
+
+		for (int i = sliceBegin(begin, end, aThread); i < sliceBegin(begin, end, aThread + 1); ++i)
+		{
+			Islands.GetConstraint(i)->PostStep(ConstraintRowList[i]);
+			Islands.GetConstraint(i)->PostStepFriction(GetFrictionRows(i));
+		}
+	};
+
+	// The calling thread is the first worker, islands solved from a worker have a single thread and run directly on it
+	SolverThreads.Run(aThreadCount, solveSlices);
+	return iterationCount;
+}
+
+void PhysicsManager::BuildSolveItems(const SimulationIslands::Island & aIsland, IslandSolverScratch & aScratch)
+{
+	int begin = aIsland.FirstConstraint;
+	int end = aIsland.FirstConstraint + aIsland.ConstraintCount;
+	std::vector<ContactBlock> & blockList = aScratch.BlockList;
+	std::vector<int> & rowBlockList = aScratch.RowBlockList;
+	blockList.clear();
+	aScratch.FirstRow = begin;
+	rowBlockList.assign(aIsland.ConstraintCount, -1);
+	aScratch.SolveItemList.clear();
+
+	if (bIsBlockSolverEnabled)
+	{
+		// Only this island touches the entries of its manifolds, so islands solved on other threads don't get in the way
+		for (int i = begin; i < end; ++i)
+		{
+			int blockID = Islands.GetConstraint(i)->GetBlockID();
+			if (blockID < 0)
+				continue;
+			int & block = ManifoldBlockList[blockID];
+			if (block < 0)
+			{
+				block = (int)blockList.size();
+				blockList.push_back(ContactBlock());
+				blockList.back().RowCount = 0;
+			}
+			ContactBlock & contactBlock = blockList[block];
+			const ConstraintRow & row = ConstraintRowList[i];
+			const ConstraintRow * firstRow = contactBlock.RowCount > 0 ? &ConstraintRowList[contactBlock.Rows[0]] : &row;
+			if (contactBlock.RowCount < ContactBlock::MaxRowCount && row.BodyA == firstRow->BodyA && row.BodyB == firstRow->BodyB)
+			{
+				contactBlock.Rows[contactBlock.RowCount++] = i;
+				rowBlockList[i - begin] = block;
+			}
+		}
+		for (int i = begin; i < end; ++i)
+		{
+			int blockID = Islands.GetConstraint(i)->GetBlockID();
+			if (blockID >= 0)
+				ManifoldBlockList[blockID] = -1;
+		}
+
+		// A manifold with a single point is just a row
+		int blockCount = 0;
+		for (ContactBlock & block : blockList)
+		{
+			if (block.RowCount == 1)
+			{
+				rowBlockList[block.Rows[0] - begin] = -1;
+				continue;
+			}
+			for (int i = 0; i < block.RowCount; ++i)
+				rowBlockList[block.Rows[i] - begin] = blockCount;
+			blockList[blockCount++] = block;
+		}
+		blockList.resize(blockCount);
+	}
+
+	for (int i = begin; i < end; ++i)
+	{
+		if (rowBlockList[i - begin] < 0)
+			aScratch.SolveItemList.push_back(i);
+	}
+	for (const ContactBlock & block : blockList)
+		aScratch.SolveItemList.push_back(block.Rows[0]);
+}
+
+void PhysicsManager::WarmStartItem(int aRow, float aDeltaTime, const IslandSolverScratch & aScratch)
+{
+	int block = aScratch.RowBlockList[aRow - aScratch.FirstRow];
+	if (block < 0)
+	{
+		WarmStartRow(aRow, aDeltaTime);
+		return;
+	}
+	const ContactBlock & contactBlock = aScratch.BlockList[block];
+	for (int i = 0; i < contactBlock.RowCount; ++i)
+		WarmStartRow(contactBlock.Rows[i], aDeltaTime);
+}
 
-				// Store previous velocities before updating
-				physicsA.PreviousLinearVelocity = physicsA.CurrentLinearVelocity;
-				physicsB.PreviousLinearVelocity = physicsB.CurrentLinearVelocity;
+SolverResidual PhysicsManager::SolveItem(int aRow, char * aDiscardFlags, float aDeltaTime, const IslandSolverScratch & aScratch)
+{
+	int block = aScratch.RowBlockList[aRow - aScratch.FirstRow];
+	if (block < 0)
+		return SolveConstraintRow(aRow, aDiscardFlags, aDeltaTime);
+
+	// Friction first like for the rows solved alone, the anchor is limited by the impulse of the whole block and only its first row has friction rows
+	const ContactBlock & contactBlock = aScratch.BlockList[block];
+	SolverResidual residual;
+	float blockImpulse = 0.0f;
+	for (int i = 0; i < contactBlock.RowCount; ++i)
+		blockImpulse += ConstraintRowList[contactBlock.Rows[i]].ImpulseSum;
+	for (int i = 0; i < contactBlock.RowCount; ++i)
+	{
+		float normalImpulse = bIsFrictionAnchorEnabled ? blockImpulse : ConstraintRowList[contactBlock.Rows[i]].ImpulseSum;
+		residual.Add(SolverBodies.SolveFrictionRows(GetFrictionRows(contactBlock.Rows[i]), normalImpulse, aDeltaTime));
+	}
+	residual.Add(SolverBodies.SolveBlock(contactBlock, ConstraintRowList, aDeltaTime));
+	return residual;
+}
 
-				physicsA.PreviousAngularVelocity = physicsA.CurrentAngularVelocity;
-				physicsB.PreviousAngularVelocity = physicsB.CurrentAngularVelocity;
+SolverResidual PhysicsManager::SolveBatchWithFriction(int aBatch, float aDeltaTime, IslandSolverScratch & aScratch)
+{
+	ConstraintRowBatch & rowBatch = aScratch.BatchList[aBatch];
+	SolverResidual residual;
+	for (int i = 0; i < ConstraintRow::FrictionRowCount; ++i)
+	{
+		ConstraintRowBatch & frictionBatch = aScratch.FrictionBatchList[ConstraintRow::FrictionRowCount * aBatch + i];
+		if (frictionBatch.ActiveMask == 0)
+			continue;
+		frictionBatch.SetFrictionLimits(rowBatch);
+		residual.Add(SolverBodies.SolveBatch(frictionBatch, aDeltaTime, IslandStats.InstructionSet));
+	}
+	residual.Add(SolverBodies.SolveBatch(rowBatch, aDeltaTime, IslandStats.InstructionSet));
+	return residual;
+}
 
-				// Create inverse mass matrices
-				matrix3 inverseMassMatrixA = matrix3(1), inverseMassMatrixB = matrix3(1);
-				inverseMassMatrixA *= physicsA.InverseMass;
-				inverseMassMatrixB *= physicsB.InverseMass;
+void PhysicsManager::SetRowBodies(int aIndex)
+{
+	Constraint * constraint = Islands.GetConstraint(aIndex);
+	ConstraintRow & row = ConstraintRowList[aIndex];
+	row.BodyA = SolverBodyIndexList[constraint->ColliderA->ColliderSlot];
+	row.BodyB = SolverBodyIndexList[constraint->ColliderB->ColliderSlot];
+}
 
-				// Create inverse inertia tensors
-				matrix3 inverseInertiaTensorA, inverseInertiaTensorB;
-				inverseInertiaTensorA = glm::inverse(constraint->ColliderA->InertiaTensor);
-				inverseInertiaTensorB = glm::inverse(constraint->ColliderB->InertiaTensor);
+void PhysicsManager::PreStepRow(int aIndex, float aDeltaTime, const IslandSolverScratch & aScratch)
+{
+	ConstraintRow & row = ConstraintRowList[aIndex];
+	Constraint * constraint = Islands.GetConstraint(aIndex);
+	constraint->PreStep(aDeltaTime, SolverBodies, row);
+
+	// Warm start, the impulse accumulated last step is the initial guess and is applied to the velocities before iterating
+	row.ImpulseSum = bIsWarmStartEnabled ? row.ImpulseSum * WarmStartFactor : 0.0f;
+	row.ImpulseSum = std::max(row.LowerLimit, std::min(row.ImpulseSum, row.UpperLimit));
+
+	// The rows of a block with a friction anchor have none of their own
+	ConstraintRow * frictionRows = GetFrictionRows(aIndex);
+	bool bHasAnchor = bIsFrictionAnchorEnabled && aScratch.RowBlockList[aIndex - aScratch.FirstRow] >= 0;
+	if (bIsFrictionEnabled && bHasAnchor == false && constraint->PreStepFriction(SolverBodies, row, frictionRows))
+		PreStepFrictionRows(frictionRows, row.ImpulseSum);
+	else
+		ClearFrictionRows(frictionRows);
+}
 
-				// Convert from local space to world space using the 3x3 submatrix of the Rotation transform
-				matrix3 rotationMatrixA = glm::mat3_cast(physicsA.pOwner->GetComponent<Transform>()->Rotation);
-				matrix3 rotationMatrixB = glm::mat3_cast(physicsB.pOwner->GetComponent<Transform>()->Rotation);
-				inverseInertiaTensorA = rotationMatrixA * inverseInertiaTensorA * glm::transpose(rotationMatrixA);
-				inverseInertiaTensorB = rotationMatrixB * inverseInertiaTensorB *  glm::transpose(rotationMatrixB);
+void PhysicsManager::PreStepFrictionAnchor(const ContactBlock & aBlock)
+{
+	// Blocks are only made of the points of a manifold, see ContactConstraint::GetBlockID
+	// The anchor starts from the tangent impulses of every point, it keeps them with the first point and clears the others,
+	// so the total carries over whichever point comes first next step, and when switching between the anchor and friction per point
+	vector3 anchorA(0.0f), anchorB(0.0f);
+	float normalImpulse = 0.0f, tangentImpulse1 = 0.0f, tangentImpulse2 = 0.0f;
+	for (int i = 0; i < aBlock.RowCount; ++i)
+	{
+		const ContactConstraint * point = static_cast<const ContactConstraint *>(Islands.GetConstraint(aBlock.Rows[i]));
+		anchorA += point->ConstraintData.ContactPositionA_WS;
+		anchorB += point->ConstraintData.ContactPositionB_WS;
+		normalImpulse += ConstraintRowList[aBlock.Rows[i]].ImpulseSum;
+		tangentImpulse1 += point->TangentImpulseSum1;
+		tangentImpulse2 += point->TangentImpulseSum2;
+	}
+	anchorA /= (float)aBlock.RowCount;
+	anchorB /= (float)aBlock.RowCount;
+
+	// The points of a manifold share the normal, so the tangents of the first one do for the anchor
+	ContactConstraint * firstPoint = static_cast<ContactConstraint *>(Islands.GetConstraint(aBlock.Rows[0]));
+	ConstraintRow * frictionRows = GetFrictionRows(aBlock.Rows[0]);
+	if (firstPoint->PreStepFrictionAnchor(SolverBodies, anchorA, anchorB, tangentImpulse1, tangentImpulse2, ConstraintRowList[aBlock.Rows[0]], frictionRows))
+		PreStepFrictionRows(frictionRows, normalImpulse);
+}
 
-				physicsA.CurrentLinearVelocity += inverseMassMatrixA * forceA;
-				physicsA.CurrentAngularVelocity += inverseInertiaTensorA * torqueA;
+void PhysicsManager::PreStepFrictionRows(ConstraintRow * aFrictionRows, float aNormalImpulse)
+{
+	// Limited by the warm started normal impulse until the iterations change it
+	for (int i = 0; i < ConstraintRow::FrictionRowCount; ++i)
+	{
+		ConstraintRow & row = aFrictionRows[i];
+		row.SetFrictionLimits(aNormalImpulse);
+		row.ImpulseSum = bIsWarmStartEnabled ? row.ImpulseSum * WarmStartFactor : 0.0f;
+		row.ImpulseSum = std::max(row.LowerLimit, std::min(row.ImpulseSum, row.UpperLimit));
+	}
+}
+
+void PhysicsManager::ClearFrictionRows(ConstraintRow * aFrictionRows)
+{
+	// Without a coefficient the solver skips them, and the constraint keeps no tangent impulse
+	for (int i = 0; i < ConstraintRow::FrictionRowCount; ++i)
+	{
+		aFrictionRows[i].FrictionCoefficient = 0.0f;
+		aFrictionRows[i].ImpulseSum = 0.0f;
+	}
+}
+
+void PhysicsManager::WarmStartRow(int aIndex, float aDeltaTime)
+{
+	const ConstraintRow & row = ConstraintRowList[aIndex];
+	if (row.ImpulseSum != 0.0f)
+		SolverBodies.ApplyImpulse(row, row.ImpulseSum * aDeltaTime);
+	const ConstraintRow * frictionRows = GetFrictionRows(aIndex);
+	for (int i = 0; i < ConstraintRow::FrictionRowCount; ++i)
+	{
+		if (frictionRows[i].ImpulseSum != 0.0f)
+			SolverBodies.ApplyImpulse(frictionRows[i], frictionRows[i].ImpulseSum * aDeltaTime);
+	}
+}
+
+SolverResidual PhysicsManager::SolveConstraintRow(int aIndex, char * aDiscardFlags, float aDeltaTime)
+{
+	SolverResidual residual;
+	if (aDiscardFlags[aIndex])
+		return residual;
+	ConstraintRow & row = ConstraintRowList[aIndex];
+	// Friction is limited by the normal impulse of the last iteration, the normal row goes last since not sinking matters more than not sliding
+	residual.Add(SolverBodies.SolveFrictionRows(GetFrictionRows(aIndex), row.ImpulseSum, aDeltaTime));
+	float deltaLambda = SolverBodies.SolveRow(row, aDeltaTime);
+
+	// Stop solving this constraint if it falls below threshold, it is removed once every island is done
+	// Each island has its own part of the list, so the other constraints are still solved this iteration
+	// A warm started constraint can start out converged, those owned by a manifold stay until their point is gone
+	if (abs(deltaLambda) < SolverBodyList::ConvergedImpulse)
+	{
+		if (Islands.GetConstraint(aIndex)->bIsDiscardable)
+			aDiscardFlags[aIndex] = 1;
+		residual.Add(0.0f, row.ImpulseSum);
+		return residual;
+	}
+
+	// Force of the constraint on each body uses the Lagrangian multiplier for magnitude and corresponding Jacobian for direction
+	// Static bodies are never written to, other islands may be reading them at the same time
+	SolverBodies.ApplyImpulse(row, deltaLambda * aDeltaTime);
+	residual.Add(deltaLambda, row.ImpulseSum);
+	return residual;
+}
+
+bool PhysicsManager::HasIslandConverged(const SolverResidual & aResidual, int aIterationCount) const
+{
+	if (aIterationCount < MinSolverIterations)
+		return false;
+	return aResidual.MaxDeltaLambda < IslandConvergenceThreshold || aResidual.GetRelative() < IslandRelativeTolerance;
+}
+
+bool PhysicsManager::WakeUpIsland(const SimulationIslands::Island & aIsland)
+{
+	bool bHasAwakeBody = false;
+	bool bHasSleepingBody = false;
+	for (int i = aIsland.FirstConstraint; i < aIsland.FirstConstraint + aIsland.ConstraintCount; ++i)
+	{
+		Constraint * constraint = Islands.GetConstraint(i);
+		Collider * colliders[2] = { constraint->ColliderA, constraint->ColliderB };
+		for (Collider * collider : colliders)
+		{
+			if (collider->eColliderType == Collider::STATIC)
+				continue;
+			bool bIsAsleep = IsColliderAtRest(collider);
+			bHasAwakeBody |= (bIsAsleep == false);
+			bHasSleepingBody |= bIsAsleep;
+		}
+	}
+	if (bHasAwakeBody == false)
+		return false;
 
-				physicsB.CurrentLinearVelocity += inverseMassMatrixB * forceB;
-				physicsB.CurrentAngularVelocity += inverseInertiaTensorB * torqueB;
+	if (bHasSleepingBody)
+	{
+		for (int i = aIsland.FirstConstraint; i < aIsland.FirstConstraint + aIsland.ConstraintCount; ++i)
+		{
+			Constraint * constraint = Islands.GetConstraint(i);
+			Collider * colliders[2] = { constraint->ColliderA, constraint->ColliderB };
+			for (Collider * collider : colliders)
+			{
+				Physics * physics = collider->GetOwner()->GetComponent<Physics>();
+				if (collider->eColliderType != Collider::STATIC && physics && physics->bIsAsleep)
+					physics->WakeUp();
 			}
 		}
 	}
+	return true;
+}
+
+void PhysicsManager::UpdateSleep()
+{
+	float deltaTime = EngineHandle.GetFramerateController().DeltaTime;
+	IslandSleepTimerList.assign(ColliderObjectsList.size(), FLT_MAX);
+
+	// A body's timer runs while it stays under both thresholds, the island can only sleep once its most recently moving body has been still for long enough
+	for (Collider * collider : DynamicColliderList)
+	{
+		Physics * physics = collider->GetOwner()->GetComponent<Physics>();
+		if (physics == nullptr || collider->eColliderType == Collider::STATIC || physics->bIsAsleep)
+			continue;
+		if (bIsSleepEnabled == false)
+		{
+			physics->SleepTimer = 0.0f;
+			continue;
+		}
+
+		bool bIsUnderThresholds = glm::dot(physics->CurrentLinearVelocity, physics->CurrentLinearVelocity) < LinearSleepThreshold * LinearSleepThreshold &&
+			glm::dot(physics->CurrentAngularVelocity, physics->CurrentAngularVelocity) < AngularSleepThreshold * AngularSleepThreshold;
+		physics->SleepTimer = bIsUnderThresholds ? physics->SleepTimer + deltaTime : 0.0f;
+
+		int root = Islands.FindRoot(collider->ColliderSlot);
+		IslandSleepTimerList[root] = std::min(IslandSleepTimerList[root], physics->SleepTimer);
+	}
+
+	for (Collider * collider : DynamicColliderList)
+	{
+		Physics * physics = collider->GetOwner()->GetComponent<Physics>();
+		if (physics == nullptr || collider->eColliderType == Collider::STATIC)
+			continue;
+
+		// Turning sleep off wakes everything that was asleep
+		if (bIsSleepEnabled == false)
+		{
+			if (physics->bIsAsleep)
+				physics->WakeUp();
+			continue;
+		}
+
+		if (physics->bIsAsleep == false && IslandSleepTimerList[Islands.FindRoot(collider->ColliderSlot)] >= TimeToSleep)
+		{
+			physics->FallAsleep();
+			++SleepStats.FellAsleepCount;
+		}
+		if (physics->bIsAsleep)
+			++SleepStats.SleepingBodyCount;
+	}
+
+	SleepStats.WokenCount = Physics::WakeUpCount;
+	Physics::WakeUpCount = 0;
 }
 
 // Based on the Expanding Polytope Algorithm (EPA) as described here: http://allenchou.net/2013/12/game-physics-contact-generation-epa/
+// The polytope lives in fixed capacity arrays owned by the manager, so no memory is allocated per call
 bool PhysicsManager::EPAContactDetection(Simplex & aSimplex, Collider * aCollider1, Collider * aCollider2, ContactData & aContactData)
 {
 	const float exitThreshold = 0.0001f;
 	const unsigned iterationLimit = 50;
-	unsigned iterationCount = 0;
-
-	std::list<PolytopeFace> polytopeFaces;
-	std::list<PolytopeEdge> polytopeEdges;
 
 	// Add all faces of simplex to the polytope
-	polytopeFaces.emplace_back(aSimplex.a, aSimplex.b, aSimplex.c);
-	polytopeFaces.emplace_back(aSimplex.a, aSimplex.c, aSimplex.d);
-	polytopeFaces.emplace_back(aSimplex.a, aSimplex.d, aSimplex.b);
-	polytopeFaces.emplace_back(aSimplex.b, aSimplex.d, aSimplex.c);
+	if (EPAPolytope.Initialize(aSimplex) == false)
+		return false;
 
-	while (true)
+	for (unsigned iterationCount = 0; iterationCount < iterationLimit; ++iterationCount)
 	{
-		if (iterationCount++ >= iterationLimit)
-		{
+		// Closest face to origin (i.e. projection of any vertex along its face normal with the least value), kept on top of the heap
+		int closestFaceIndex = EPAPolytope.PopClosestFace();
+		if (closestFaceIndex < 0)
 			return false;
-		}
-		// Find the closest face to origin (i.e. projection of any vertex along its face normal with the least value)
-		float minimumDistance = std::numeric_limits<float>::max();
-		std::list<PolytopeFace>::iterator closestFace = polytopeFaces.begin();
-		for (auto iterator = polytopeFaces.begin(); iterator != polytopeFaces.end(); ++iterator)
-		{
-			float distance = glm::dot(iterator->FaceNormal, iterator->Points[0].MinkowskiHullVertex);
-			if (distance < minimumDistance)
-			{
-				minimumDistance = distance;
-				closestFace = iterator;
-			}
-		}
+		const ExpandingPolytope::Face & closestFace = EPAPolytope.GetFace(closestFaceIndex);
+
 		// With the closest face now known, find new support point on the Minkowski Hull using normal to that face
-		SupportPoint newPolytopePoint = Utility::Support(aCollider1, aCollider2, closestFace->FaceNormal, aCollider1->LocalToWorldMatrix,aCollider2->LocalToWorldMatrix);
+		SupportPoint newPolytopePoint = Utility::Support(aCollider1, aCollider2, closestFace.Normal, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
 
 		// If this new point is within a tolerable limit of the origin, 
 		// assume we have found the closest triangle on the Minkowski Hull to the origin
-		if (glm::dot(closestFace->FaceNormal, newPolytopePoint.MinkowskiHullVertex) - minimumDistance < exitThreshold)
+		if (glm::dot(closestFace.Normal, newPolytopePoint.MinkowskiHullVertex) - closestFace.Distance < exitThreshold)
 		{
+			PolytopeFace contactFace(EPAPolytope.GetVertex(closestFace.Vertices[0]), EPAPolytope.GetVertex(closestFace.Vertices[1]), EPAPolytope.GetVertex(closestFace.Vertices[2]));
+			contactFace.FaceNormal = closestFace.Normal;
+
 			LineLoop closestFaceObjectA;
 			closestFaceObjectA.Color = glm::vec4(1, 1, 0, 1);
-			closestFaceObjectA.AddVertex(closestFace->Points[0].World_SupportPointA);
-			closestFaceObjectA.AddVertex(closestFace->Points[1].World_SupportPointA);
-			closestFaceObjectA.AddVertex(closestFace->Points[2].World_SupportPointA);
+			closestFaceObjectA.AddVertex(contactFace.Points[0].World_SupportPointA);
+			closestFaceObjectA.AddVertex(contactFace.Points[1].World_SupportPointA);
+			closestFaceObjectA.AddVertex(contactFace.Points[2].World_SupportPointA);
 
 			LineLoop closestFaceObjectB;
 			closestFaceObjectB.Color = glm::vec4(0, 1, 1, 1);
-			closestFaceObjectB.AddVertex(closestFace->Points[0].World_SupportPointB);
-			closestFaceObjectB.AddVertex(closestFace->Points[1].World_SupportPointB);
-			closestFaceObjectB.AddVertex(closestFace->Points[2].World_SupportPointB);
+			closestFaceObjectB.AddVertex(contactFace.Points[0].World_SupportPointB);
+			closestFaceObjectB.AddVertex(contactFace.Points[1].World_SupportPointB);
+			closestFaceObjectB.AddVertex(contactFace.Points[2].World_SupportPointB);
 
 			LineLoop closestPolytopeFace;
 			closestPolytopeFace.Color = glm::vec4(1, 0, 1, 1);
-			closestPolytopeFace.AddVertex(closestFace->Points[0].MinkowskiHullVertex);
-			closestPolytopeFace.AddVertex(closestFace->Points[1].MinkowskiHullVertex);
-			closestPolytopeFace.AddVertex(closestFace->Points[2].MinkowskiHullVertex);
+			closestPolytopeFace.AddVertex(contactFace.Points[0].MinkowskiHullVertex);
+			closestPolytopeFace.AddVertex(contactFace.Points[1].MinkowskiHullVertex);
+			closestPolytopeFace.AddVertex(contactFace.Points[2].MinkowskiHullVertex);
 
 			EngineHandle.GetDebugFactory().RegisterDebugLineLoop(closestFaceObjectA);
 			EngineHandle.GetDebugFactory().RegisterDebugLineLoop(closestFaceObjectB);
@@ -647,37 +1583,14 @@ bool PhysicsManager::EPAContactDetection(Simplex & aSimplex, Collider * aCollide
 			if (EngineHandle.GetInputManager().isKeyPressed(GLFW_KEY_SPACE))
 				EngineHandle.GetEngineStateManager().bShouldSimulationRun = false;
 
-			return ExtrapolateContactInformation(&(*closestFace), aContactData, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
-		}
-
-		// Otherwise, check what faces can be 'seen' from the newly added support point and delete them from the polytope
-		for (auto iterator = polytopeFaces.begin(); iterator != polytopeFaces.end();)
-		{
-			// A face is considered as "seen" if the new support point is on the positive halfspace of the plane defined by it
-			vector3 planeVector = newPolytopePoint.MinkowskiHullVertex - iterator->Points[0].MinkowskiHullVertex;
-
-			if (glm::dot(iterator->FaceNormal, planeVector) > 0.0f)
-			{
-				// Only adds the outside edges of the 'seen' face, and ignores the others
-				Utility::AddEdge(polytopeEdges, iterator->Points[0], iterator->Points[1]);
-				Utility::AddEdge(polytopeEdges, iterator->Points[1], iterator->Points[2]);
-				Utility::AddEdge(polytopeEdges, iterator->Points[2], iterator->Points[0]);
-				// Remove the face from the Polytope
-				iterator = polytopeFaces.erase(iterator);
-				continue;
-			}
-			++iterator;
-		}
-
-		// Create new polytope faces using the new support point from the valid edges in the edge list
-		for (auto iterator = polytopeEdges.begin(); iterator != polytopeEdges.end(); ++iterator)
-		{
-			polytopeFaces.emplace_back(newPolytopePoint, iterator->Points[0], iterator->Points[1]);
+			return ExtrapolateContactInformation(&contactFace, aContactData, aCollider1->LocalToWorldMatrix, aCollider2->LocalToWorldMatrix);
 		}
 
-		// Clear the edge list every iteration of the expansion
-		polytopeEdges.clear();
+		// Otherwise, remove every face that can 'see' the new support point and fill the hole with faces connecting it to the horizon
+		if (EPAPolytope.Expand(closestFaceIndex, newPolytopePoint) == false)
+			return false;
 	}
+	return false;
 }
 
 // By using the closest face of the Minkowski hull to the origin in Minkowski space, 
@@ -759,6 +1672,78 @@ void PhysicsManager::RegisterColliderObject(Collider * aNewCollider)
 {
 	aNewCollider->ColliderSlot = (int)ColliderObjectsList.size();
 	ColliderObjectsList.push_back(aNewCollider);
+	// Colliders registered after the static geometry is built are always treated as dynamic
+	DynamicColliderList.push_back(aNewCollider);
+	// Every broadphase tracks all colliders so the mode can be switched at runtime
+	SweepAndPruneBroadphase.AddCollider(aNewCollider);
+	AABBTreeBroadphase.AddCollider(aNewCollider);
+	HashGridBroadphase.AddCollider(aNewCollider);
+}
+
+void PhysicsManager::UnregisterColliderObject(Collider * aCollider)
+{
+	int slot = aCollider->ColliderSlot;
+	auto dynamicIterator = std::find(DynamicColliderList.begin(), DynamicColliderList.end(), aCollider);
+	bool bIsStaticGeometry = (dynamicIterator == DynamicColliderList.end());
+
+	if (bIsStaticGeometry == false)
+	{
+		DynamicColliderList.erase(dynamicIterator);
+		SweepAndPruneBroadphase.RemoveCollider(aCollider);
+		AABBTreeBroadphase.RemoveCollider(aCollider);
+		HashGridBroadphase.RemoveCollider(aCollider);
+	}
+	CollidingStaticColliderList.erase(std::remove(CollidingStaticColliderList.begin(), CollidingStaticColliderList.end(), aCollider), CollidingStaticColliderList.end());
+
+	// Cached pairs are keyed by slot, the next collider to take this slot must not find this collider's pairs
+	// Their manifolds are released first, along with the constraints they own
+	CollisionPairCache.RemovePairsWithSlot(slot);
+	ReleaseEvictedManifolds();
+
+	// Constraints can't outlive either of their colliders
+	for (int i = 0; i < (int)ConstraintObjectsList.size();)
+	{
+		Constraint * constraint = ConstraintObjectsList[i];
+		if (constraint->ColliderA == aCollider || constraint->ColliderB == aCollider)
+		{
+			UnregisterConstraintObject(constraint);
+			delete constraint;
+			continue;
+		}
+		++i;
+	}
+
+	// Keep the slots contiguous by moving the last collider into the freed slot
+	Collider * lastCollider = ColliderObjectsList.back();
+	ColliderObjectsList.pop_back();
+	if (lastCollider != aCollider)
+	{
+		int lastSlot = lastCollider->ColliderSlot;
+		// Broadphase proxies are keyed by slot too, the moved collider is reinserted under its new slot
+		bool bIsInBroadphases = std::find(DynamicColliderList.begin(), DynamicColliderList.end(), lastCollider) != DynamicColliderList.end();
+		if (bIsInBroadphases)
+		{
+			SweepAndPruneBroadphase.RemoveCollider(lastCollider);
+			AABBTreeBroadphase.RemoveCollider(lastCollider);
+			HashGridBroadphase.RemoveCollider(lastCollider);
+		}
+
+		lastCollider->ColliderSlot = slot;
+		ColliderObjectsList[slot] = lastCollider;
+
+		if (bIsInBroadphases)
+		{
+			SweepAndPruneBroadphase.AddCollider(lastCollider);
+			AABBTreeBroadphase.AddCollider(lastCollider);
+			HashGridBroadphase.AddCollider(lastCollider);
+		}
+		CollisionPairCache.MoveSlot(lastSlot, slot);
+		ReleaseEvictedManifolds();
+	}
+
+	// The static BVH is immutable, it is rebuilt without the removed collider
+	if (bIsStaticGeometry)
+		BuildStaticGeometry();
 }
 
 void PhysicsManager::RegisterConstraintObject(Constraint * aNewConstraint)
@@ -773,6 +1758,95 @@ void PhysicsManager::RegisterManifoldObject(ContactManifold * aNewManifold)
 	ManifoldObjectsList.push_back(aNewManifold);
 }
 
+void PhysicsManager::UnregisterConstraintObject(Constraint * aConstraint)
+{
+	// Swap with the last constraint so the list stays contiguous
+	int slot = aConstraint->ConstraintSlot;
+	ConstraintObjectsList[slot] = ConstraintObjectsList.back();
+	ConstraintObjectsList[slot]->ConstraintSlot = slot;
+	ConstraintObjectsList.pop_back();
+}
+
+ContactManifold & PhysicsManager::AcquireManifold(PairCache::CachedPair & aCachedPair)
+{
+	if (aCachedPair.ManifoldID < 0)
+	{
+		if (FreeManifoldSlotList.empty())
+		{
+			ContactManifold * newManifold = new ContactManifold();
+			RegisterManifoldObject(newManifold);
+			aCachedPair.ManifoldID = newManifold->ManifoldSlot;
+		}
+		else
+		{
+			aCachedPair.ManifoldID = FreeManifoldSlotList.back();
+			FreeManifoldSlotList.pop_back();
+		}
+	}
+	return *ManifoldObjectsList[aCachedPair.ManifoldID];
+}
+
+void PhysicsManager::ReleaseManifold(int aManifoldID)
+{
+	ContactManifold * manifold = ManifoldObjectsList[aManifoldID];
+	for (ContactConstraint *& constraint : manifold->pConstraints)
+	{
+		if (constraint == nullptr)
+			continue;
+		UnregisterConstraintObject(constraint);
+		delete constraint;
+		constraint = nullptr;
+	}
+	manifold->Clear();
+	FreeManifoldSlotList.push_back(aManifoldID);
+}
+
+void PhysicsManager::ReleaseEvictedManifolds()
+{
+	for (int manifoldID : CollisionPairCache.ReleasedManifoldList)
+		ReleaseManifold(manifoldID);
+	CollisionPairCache.ReleasedManifoldList.clear();
+	for (ContactConstraint * constraint : CollisionPairCache.ReleasedConstraintList)
+	{
+		UnregisterConstraintObject(constraint);
+		delete constraint;
+	}
+	CollisionPairCache.ReleasedConstraintList.clear();
+}
+
+void PhysicsManager::UpdateManifoldConstraints(ContactManifold & aManifold, Collider * aColliderA, Collider * aColliderB)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		ContactConstraint *& constraint = aManifold.pConstraints[i];
+		if (i >= aManifold.Size)
+		{
+			// The manifold lost this point
+			if (constraint)
+			{
+				UnregisterConstraintObject(constraint);
+				delete constraint;
+				constraint = nullptr;
+			}
+			continue;
+		}
+
+		if (constraint == nullptr)
+		{
+			constraint = new ContactConstraint(*aColliderA, *aColliderB);
+			constraint->ManifoldID = aManifold.ManifoldSlot;
+			constraint->bIsDiscardable = false;
+			RegisterConstraintObject(constraint);
+		}
+		// Points matched to one from the last step carry its accumulated impulses, which warm start the solver
+		const ContactData & point = aManifold.ManifoldPoints[i];
+		constraint->ConstraintData = point;
+		constraint->NormalImpulseSum = point.NormalImpulse;
+		constraint->TangentImpulseSum1 = point.TangentImpulse1;
+		constraint->TangentImpulseSum2 = point.TangentImpulse2;
+	}
+}
+
 void PhysicsManager::Simulation()
 {
 	Physics * pSimulation1 = nullptr, * pSimulation2 = nullptr;
@@ -783,6 +1857,10 @@ void PhysicsManager::Simulation()
 		for (auto iterator = PhysicsObjectsList.begin(); iterator != PhysicsObjectsList.end(); ++iterator)
 		{
 			pSimulation1 = static_cast<Physics *>(*iterator);
+			// Sleeping bodies are not integrated, an edit to their transform wakes them first
+			pSimulation1->WakeUpIfMoved();
+			if (pSimulation1->bIsAsleep)
+				continue;
 			// Updates physics component with current transform values
 			pSimulation1->SyncPhysicsWithTransform();
 
@@ -2,6 +2,17 @@
 #include "Observer.h"
 #include "GameObject.h"
 #include "PhysicsUtilities.h"
+#include "SweepAndPrune.h"
+#include "DynamicTreeBroadphase.h"
+#include "SpatialHashGrid.h"
+#include "StaticBVH.h"
+#include "PairCache.h"
+#include "SignedVolumesGJK.h"
+#include "ExpandingPolytope.h"
+#include "SimulationIslands.h"
+#include "SolverData.h"
+#include "ConstraintGraphColoring.h"
+#include "SolverThreadPool.h"
 #include "Typedefs.h"
 
 class CollideEvent : public Event
@@ -25,12 +36,185 @@ class PhysicsManager : public Observer
 {
 	/*----------MEMBER VARIABLES----------*/
 public:
+	// Selects how candidate pairs are found before running the narrowphase
+	enum BroadphaseMode
+	{
+		BRUTE_FORCE,
+		SWEEP_AND_PRUNE,
+		DYNAMIC_AABB_TREE,
+		SPATIAL_HASH_GRID,
+		BroadphaseModeCount
+	};
+	static const char * BroadphaseModeName[BroadphaseModeCount];
+
+	// Selects how candidate pairs are tested and their contacts generated
+	enum NarrowphaseMode
+	{
+		// Boolean GJK, EPA for every intersecting pair
+		GJK_EPA,
+		// Signed Volumes distance queries, the full shapes for the separation test and the core shapes for the contact normal, EPA only once the cores overlap
+		SIGNED_VOLUMES,
+		NarrowphaseModeCount
+	};
+	static const char * NarrowphaseModeName[NarrowphaseModeCount];
+
+	struct BroadphaseStatistics
+	{
+		// Pairs handed to GJK
+		int CandidatePairCount = 0;
+		// Pairs GJK found to be intersecting
+		int CollidingPairCount = 0;
+		// Milliseconds, of the last frame this mode was active
+		float BroadphaseTime = 0.0f;
+		float NarrowphaseTime = 0.0f;
+	};
+
+	struct GJKStatistics
+	{
+		int CallCount = 0;
+		// Support function evaluations, rebuilding a cached simplex counts as one
+		int IterationCount = 0;
+		// Calls that finished using only the cached separating axis or simplex
+		int WarmStartHitCount = 0;
+	};
+
+	struct SignedVolumesStatistics
+	{
+		int CallCount = 0;
+		int IterationCount = 0;
+		// Contacts generated from the core distance alone
+		int ShallowContactCount = 0;
+		// Pairs whose cores overlapped and went through GJK and EPA
+		int EPAFallbackCount = 0;
+	};
+
+	struct PairKernelStatistics
+	{
+		// Pairs handled by a kernel from NarrowphaseDispatch
+		int CallCount = 0;
+		int ContactCount = 0;
+	};
+
+	struct ContactReuseStatistics
+	{
+		// Pairs with a manifold from an earlier step that could be reused
+		int CandidateCount = 0;
+		// Pairs whose manifold was reused instead of running the narrowphase
+		int HitCount = 0;
+	};
+
+	struct IslandStatistics
+	{
+		int IslandCount = 0;
+		// Constraints in the largest island
+		int LargestIslandSize = 0;
+		// Summed over every island, each stops as soon as it converges
+		int IterationCount = 0;
+		// Most iterations taken by an island
+		int MaxIterationCount = 0;
+		// Largest change relative to the impulses in the last iteration of an island, above the tolerance for islands that ran out of iterations
+		float MaxRelativeResidual = 0.0f;
+		// Most threads used at once, by the colored islands or by the ones solved one per thread
+		int ThreadCount = 0;
+		// Islands split across threads by graph coloring
+		int ColoredIslandCount = 0;
+		// Most colors needed by a colored island, including the batch of rows that didn't fit in one
+		int ColorCount = 0;
+		// Row batches solved by the wide solver, summed over every island
+		int BatchCount = 0;
+		// Manifolds solved by the block solver
+		int BlockCount = 0;
+		// Rows along the contact tangents, two per contact point or per manifold anchor
+		int FrictionRowCount = 0;
+		// Used by the wide solver, the selected one clamped to what the CPU supports
+		SIMD::InstructionSet InstructionSet = SIMD::SCALAR;
+		// Milliseconds, prestep and iterations of every island
+		float SolveTime = 0.0f;
+	};
+
+	struct SleepStatistics
+	{
+		// Dynamic bodies asleep after the step
+		int SleepingBodyCount = 0;
+		int FellAsleepCount = 0;
+		// Bodies woken by contact, forces or transform edits
+		int WokenCount = 0;
+		// Islands the solver skipped because all their bodies were asleep
+		int SleepingIslandCount = 0;
+	};
+
+	// Coloring and row batches of an island solved by SolveColoredIsland
+	struct IslandSolverScratch
+	{
+		ConstraintGraphColoring Coloring;
+		std::vector<ConstraintRowBatch> BatchList;
+		// Friction rows of the rows of each batch, ConstraintRow::FrictionRowCount batches per batch with the same lanes
+		std::vector<ConstraintRowBatch> FrictionBatchList;
+		// Index of the first batch of each color, plus the end of the last one
+		std::vector<int> ColorBatchStartList;
+		// Position in the coloring of the first block of each color, the rows solved alone come before it
+		std::vector<int> ColorBlockStartList;
+		// Manifolds with 2 to 4 points in the island
+		std::vector<ContactBlock> BlockList;
+		// First row of the island
+		int FirstRow = 0;
+		// Indexed by row - FirstRow, block of the row or -1 if it is solved alone
+		std::vector<int> RowBlockList;
+		// The rows solved alone followed by the first row of each block, what the island solver iterates over
+		std::vector<int> SolveItemList;
+	};
+
+	struct ManifoldStatistics
+	{
+		// Points in all manifolds after the update
+		int ContactCount = 0;
+		// Points matched to one from the previous step
+		int PersistentContactCount = 0;
+		// Points that separated or slid too far since they were found
+		int DroppedContactCount = 0;
+	};
+
 	static int IntegratorIterations;
-	const static int ConstraintSolverIterations = 10;
+	// Most iterations an island takes, it stops earlier once converged but never before MinSolverIterations
+	static int ConstraintSolverIterations;
+	int MinSolverIterations = 1;
+	// Accumulated impulses of the last step are applied before the iterations, scaled by the factor
+	bool bIsWarmStartEnabled = true;
+	float WarmStartFactor = 0.9f;
+	// An island stops iterating once no constraint's impulse changes by more than this in an iteration,
+	// or by more than the relative tolerance times the largest impulse of the island, whichever comes first
+	float IslandConvergenceThreshold = 0.0001f;
+	float IslandRelativeTolerance = 0.001f;
+	bool bIsIslandSolverMultithreaded = true;
+	// Below this many constraints per thread the cost of starting the threads outweighs the gain
+	int MinConstraintsPerThread = 64;
+	// Islands with enough constraints for two threads are graph colored and each color is solved in parallel slices
+	bool bIsGraphColoringEnabled = true;
+	// Colored islands solve their rows in batches of 8 with the selected instruction set, smaller islands are colored for it too
+	// Every instruction set gives the same result, the scalar one is the reference to validate the others against
+	bool bIsBatchSolverEnabled = true;
+	SIMD::InstructionSet eSolverInstructionSet = SIMD::AVX2;
+	// Below this many constraints an island doesn't fill enough batches to be worth coloring
+	int MinBatchedConstraintCount = 32;
+	// The normal impulses of the 2 to 4 points of a manifold are solved together instead of one point at a time
+	bool bIsBlockSolverEnabled = true;
+	// Blocks above this estimated condition number are solved with sequential impulses, the direct solve is too imprecise
+	float BlockSolverMaxConditionNumber = 1000.0f;
+	// Contacts get two friction rows along their tangents, limited by the friction coefficient times the normal impulse
+	bool bIsFrictionEnabled = true;
+	// Manifolds solved as a block get a single pair of friction rows at the middle of their points instead of a pair per point,
+	// each of the two directions is limited on its own by the impulse of the whole manifold
+	bool bIsFrictionAnchorEnabled = false;
 	// Stability analysis provides an upper bound of β ≤ 1/∆t for smooth decay
 	float BaumgarteScalar = 0.0035f;
 	float PenetrationSlop = 0.0005f;
 	float RestitutionSlop = 0.5f;
+	// An island falls asleep once every body in it has stayed under both velocity thresholds for TimeToSleep seconds
+	bool bIsSleepEnabled = true;
+	float LinearSleepThreshold = 0.05f;
+	// In radians per second
+	float AngularSleepThreshold = 0.05f;
+	float TimeToSleep = 0.5f;
 	/*---ENGINE REFERENCE ---*/
 	Engine & EngineHandle;
 
@@ -38,6 +222,67 @@ public:
 	std::vector<Collider *> ColliderObjectsList;
 	std::vector<Constraint *> ConstraintObjectsList;
 	std::vector<ContactManifold *> ManifoldObjectsList;
+	// Slots in ManifoldObjectsList not used by any pair
+	std::vector<int> FreeManifoldSlotList;
+	// Every collider that is not part of the static geometry, all colliders until the static geometry is built
+	std::vector<Collider *> DynamicColliderList;
+
+	BroadphaseMode eBroadphaseMode = SWEEP_AND_PRUNE;
+	SweepAndPrune SweepAndPruneBroadphase;
+	DynamicTreeBroadphase AABBTreeBroadphase;
+	SpatialHashGrid HashGridBroadphase;
+	// Static colliders are moved out of the broadphases above into this tree once the engine has loaded
+	StaticBVH StaticGeometry;
+	bool bIsStaticGeometryBuilt = false;
+	// Static colliders that were colored as colliding last frame and have to be reset
+	std::vector<Collider *> CollidingStaticColliderList;
+	// Output of the broadphase, rebuilt every frame
+	std::vector<ColliderPair> CollisionPairList;
+	// Kept per mode so they can be compared side by side after switching modes
+	BroadphaseStatistics BroadphaseStats[BroadphaseModeCount];
+	// Data kept between steps for every candidate pair, contact constraints and GJK warm start data
+	PairCache CollisionPairCache;
+	bool bIsGJKWarmStartEnabled = true;
+	NarrowphaseMode eNarrowphaseMode = GJK_EPA;
+	// Shape pairs with a specialized kernel skip the narrowphase mode above
+	bool bIsPairKernelDispatchEnabled = true;
+	// Manifold points are kept between steps and matched to the new ones, otherwise each manifold is rebuilt every step
+	bool bIsPersistentManifoldEnabled = true;
+	// Pairs whose relative pose moved less than these since their manifold was built reuse it without running the narrowphase
+	bool bIsContactReuseEnabled = true;
+	float ContactReuseLinearThreshold = 0.001f;
+	// In radians
+	float ContactReuseAngularThreshold = 0.01f;
+	SignedVolumesGJK SignedVolumesNarrowphase;
+	// Scratch polytope reused by every EPA call
+	ExpandingPolytope EPAPolytope;
+	// Of the last step
+	GJKStatistics GJKStats;
+	SignedVolumesStatistics SignedVolumesStats;
+	PairKernelStatistics PairKernelStats;
+	ManifoldStatistics ManifoldStats;
+	ContactReuseStatistics ContactReuseStats;
+	IslandStatistics IslandStats;
+	SleepStatistics SleepStats;
+	// Rebuilt at the start of every solve
+	SimulationIslands Islands;
+	// Awake bodies and constraint rows of the current solve
+	SolverBodyList SolverBodies;
+	std::vector<ConstraintRow> ConstraintRowList;
+	// ConstraintRow::FrictionRowCount rows per constraint row, in the same order, without a friction coefficient for the rows that have no friction
+	std::vector<ConstraintRow> FrictionRowList;
+	// Indexed by collider slot, solver body of the collider
+	std::vector<int> SolverBodyIndexList;
+	// One per thread, reused between islands and steps
+	std::vector<IslandSolverScratch> SolverScratchList;
+	// Workers of the island solver, started once and parked between steps
+	SolverThreadPool SolverThreads;
+	// Indexed by manifold slot, block of the manifold in the island being set up, -1 outside of BuildSolveItems
+	std::vector<int> ManifoldBlockList;
+	// Indexed by island root, lowest sleep timer of the bodies in the island
+	std::vector<float> IslandSleepTimerList;
+	// Incremented once per Update, used to find pairs that stopped colliding
+	unsigned int StepCount = 0;
 	/*----------MEMBER FUNCTIONS----------*/
 	PhysicsManager(Engine & aEngine) :EngineHandle(aEngine) {};
 	~PhysicsManager() {};
@@ -45,24 +290,88 @@ public:
 	// Registration functions
 	void RegisterPhysicsObject(Physics * aNewPhysics);
 	void RegisterColliderObject(Collider * aNewCollider);
+	// Removes the collider from every broadphase and moves the last collider into its slot
+	void UnregisterColliderObject(Collider * aCollider);
 	void RegisterConstraintObject(Constraint * aNewConstraint);
 	void RegisterManifoldObject(ContactManifold * aNewManifold);
+	// Swaps the last constraint into the freed slot, doesn't delete the constraint
+	void UnregisterConstraintObject(Constraint * aConstraint);
+	// Manifold of the pair, taking a free slot if it doesn't have one yet
+	ContactManifold & AcquireManifold(PairCache::CachedPair & aCachedPair);
+	// Deletes the constraints of the manifold and frees its slot
+	void ReleaseManifold(int aManifoldID);
+	// Releases the manifolds and deletes the single constraints the pair cache let go of
+	void ReleaseEvictedManifolds();
+	// Creates, updates or deletes one contact constraint per point of the manifold
+	void UpdateManifoldConstraints(ContactManifold & aManifold, Collider * aColliderA, Collider * aColliderB);
 
 	// Main function of physics manager, calls all other functions
 	void Update();
 
 	// Performs integration of all physics objects
 	void Simulation();
+	// Puts islands that have been at rest long enough to sleep, uses the islands of the last solve
+	void UpdateSleep();
+	// Static colliders and colliders of sleeping bodies
+	bool IsColliderAtRest(Collider * aCollider) const;
 
-	// Detects collision between all pairs of collider objects
+	// Detects collision between all pairs of collider objects found by the broadphase
 	void DetectCollision();
-	bool GJKCollisionHandler(Collider * aCollider1, Collider * aCollider2, ContactData & aContactData);
+	// Recalculates the model matrix and world space bounds of every dynamic collider
+	void UpdateColliderBounds();
+	void UpdateColliderBounds(Collider * aCollider);
+	// Fills the collision pair list using the current broadphase mode
+	void FindCollisionPairs();
+	// Appends the pairs between dynamic colliders and the static geometry, static pairs are never generated
+	void FindStaticGeometryPairs();
+	// Builds the static BVH from every static collider and removes them from the dynamic broadphases
+	void BuildStaticGeometry();
+	// Pose of aColliderB in the space of aColliderA
+	matrix4 GetRelativeTransform(Collider * aColliderA, Collider * aColliderB) const;
+	// True if the relative pose moved less than the contact reuse thresholds, rotation and translation are compared separately
+	// aScaleA is the scale of collider A, the relative poses are in its scaled local space
+	bool IsContactPoseReusable(const matrix4 & aPreviousTransform, const matrix4 & aCurrentTransform, const vector3 & aScaleA) const;
+	// Warm starts from the separating axis or simplex cached for the pair if there is one, and updates them
+	bool GJKCollisionHandler(Collider * aCollider1, Collider * aCollider2, ContactData & aContactData, PairCache::CachedPair * aCachedPair = nullptr);
+	// Contact from the closest points of the core shapes, falls back to GJKCollisionHandler when the cores overlap
+	bool SignedVolumesCollisionHandler(Collider * aCollider1, Collider * aCollider2, ContactData & aContactData, PairCache::CachedPair * aCachedPair = nullptr);
 	bool EPAContactDetection(Simplex & aSimplex, Collider * aShape1, Collider * aShape2, ContactData & aContactData);
 	bool ExtrapolateContactInformation(PolytopeFace * aClosestFace, ContactData & aContactData, matrix4 & aLocalToWorldMatrixA, matrix4 & aLocalToWorldMatrixB);
 	bool CheckIfSimplexContainsOrigin(Simplex & aSimplex, vector3 & aSearchDirection);
 
 	// Resolves pairwise constraints that are violated
 	void SolveConstraints();
+	// Prestep and Gauss-Seidel iterations over the rows of one island, returns the number of iterations it took to converge
+	// Constraints that fall below threshold get their flag set in aDiscardFlags, indexed like the island constraint list
+	// aResidual is left with the residual of the last iteration
+	int SolveIsland(const SimulationIslands::Island & aIsland, char * aDiscardFlags, float aDeltaTime, IslandSolverScratch & aScratch, SolverResidual & aResidual);
+	// Same as SolveIsland with the island's rows colored and each color split between aThreadCount threads
+	// The result depends on the coloring only, the same for any thread count
+	int SolveColoredIsland(const SimulationIslands::Island & aIsland, char * aDiscardFlags, float aDeltaTime, int aThreadCount, IslandSolverScratch & aScratch, SolverResidual & aResidual);
+	// Groups the rows of the island's manifolds into blocks and lists what the solver iterates over, the row bodies must be set
+	void BuildSolveItems(const SimulationIslands::Island & aIsland, IslandSolverScratch & aScratch);
+	// Warm starts or solves the row, or the whole block if it is the first row of one
+	void WarmStartItem(int aRow, float aDeltaTime, const IslandSolverScratch & aScratch);
+	SolverResidual SolveItem(int aRow, char * aDiscardFlags, float aDeltaTime, const IslandSolverScratch & aScratch);
+	// Steps of the island solvers for the row aIndex of ConstraintRowList
+	void SetRowBodies(int aIndex);
+	// Fills the row and its friction rows, and scales the impulses from last step for the warm start
+	void PreStepRow(int aIndex, float aDeltaTime, const IslandSolverScratch & aScratch);
+	// Friction rows of the anchor of the block, kept with its first row
+	void PreStepFrictionAnchor(const ContactBlock & aBlock);
+	void PreStepFrictionRows(ConstraintRow * aFrictionRows, float aNormalImpulse);
+	void ClearFrictionRows(ConstraintRow * aFrictionRows);
+	inline ConstraintRow * GetFrictionRows(int aIndex) { return &FrictionRowList[ConstraintRow::FrictionRowCount * aIndex]; }
+	// Warm starts the row and its friction rows
+	void WarmStartRow(int aIndex, float aDeltaTime);
+	// Solves the friction rows then the row, the residual is empty if the row was discarded
+	SolverResidual SolveConstraintRow(int aIndex, char * aDiscardFlags, float aDeltaTime);
+	// The friction batches of the batch then the batch itself
+	SolverResidual SolveBatchWithFriction(int aBatch, float aDeltaTime, IslandSolverScratch & aScratch);
+	// Within the minimum and maximum iteration counts, an island stops once the residual of an iteration is under either threshold
+	bool HasIslandConverged(const SolverResidual & aResidual, int aIterationCount) const;
+	// False if every dynamic body of the island is asleep, otherwise wakes the sleeping ones so the whole island is solved
+	bool WakeUpIsland(const SimulationIslands::Island & aIsland);
 
 	virtual void OnNotify(Event * aEvent) override;
 
@@ -0,0 +1,176 @@
+#include <cfloat>
+#include <cmath>
+#include "PhysicsUtilities.h"
+#include "ContactConstraint.h"
+
+namespace
+{
+	// Twice the area of the convex quad through the 4 points, whatever their order
+	// One of the three ways to pair them up gives the diagonals, which span the largest cross product
+	float GetQuadArea(const vector3 & aPointA, const vector3 & aPointB, const vector3 & aPointC, const vector3 & aPointD)
+	{
+		float area = glm::length(glm::cross(aPointA - aPointC, aPointB - aPointD));
+		area = std::max(area, glm::length(glm::cross(aPointA - aPointB, aPointC - aPointD)));
+		area = std::max(area, glm::length(glm::cross(aPointA - aPointD, aPointB - aPointC)));
+		return area;
+	}
+
+	// aNewContact is a new measurement of aPreviousContact, it carries on its lifetime and accumulated impulses
+	void InheritContact(ContactData & aNewContact, const ContactData & aPreviousContact)
+	{
+		aNewContact.Lifetime = aPreviousContact.Lifetime + 1;
+		aNewContact.NormalImpulse = aPreviousContact.NormalImpulse;
+		aNewContact.TangentImpulse1 = aPreviousContact.TangentImpulse1;
+		aNewContact.TangentImpulse2 = aPreviousContact.TangentImpulse2;
+	}
+}
+
+// Branchless basis from Duff et al., Building an Orthonormal Basis, Revisited, continuous everywhere but at normals along -z
+void ContactData::CalculateTangents()
+{
+	float sign = std::copysign(1.0f, Normal.z);
+	float a = -1.0f / (sign + Normal.z);
+	float b = Normal.x * Normal.y * a;
+	Tangent1 = vector3(1.0f + sign * Normal.x * Normal.x * a, sign * b, -sign * Normal.x);
+	Tangent2 = vector3(b, sign + Normal.y * Normal.y * a, -Normal.y);
+}
+
+// Persistent manifold as in Bullet's btPersistentManifold, points are kept in local space and revalidated every step
+int ContactManifold::ValidateAllContacts(const matrix4 & aLocalToWorldA, const matrix4 & aLocalToWorldB)
+{
+	int removedCount = 0;
+	for (int i = Size - 1; i >= 0; --i)
+	{
+		ContactData & contact = ManifoldPoints[i];
+		contact.ContactPositionA_WS = vector3(aLocalToWorldA * vector4(contact.ContactPositionA_LS, 1));
+		contact.ContactPositionB_WS = vector3(aLocalToWorldB * vector4(contact.ContactPositionB_LS, 1));
+		contact.PenetrationDepth = glm::dot(contact.ContactPositionA_WS - contact.ContactPositionB_WS, contact.Normal);
+
+		// Drift is the part of the offset between the two points that is along the surface
+		vector3 drift = contact.ContactPositionB_WS - (contact.ContactPositionA_WS - contact.PenetrationDepth * contact.Normal);
+		bool bHasSeparated = contact.PenetrationDepth < -ContactBreakingThreshold;
+		bool bHasDrifted = glm::dot(drift, drift) > ContactBreakingThreshold * ContactBreakingThreshold;
+		if (bHasSeparated || bHasDrifted)
+		{
+			// Order doesn't matter, each point carries its own data
+			ManifoldPoints[i] = ManifoldPoints[--Size];
+			++removedCount;
+		}
+	}
+	return removedCount;
+}
+
+int ContactManifold::ValidateNewContact(const ContactData & aNewContact, unsigned int aExcludedMask) const
+{
+	int closestPoint = -1;
+	float closestDistance = ContactBreakingThreshold * ContactBreakingThreshold;
+	for (int i = 0; i < Size; ++i)
+	{
+		if (aExcludedMask & (1u << i))
+			continue;
+
+		const ContactData & contact = ManifoldPoints[i];
+		if (aNewContact.FeatureID != 0 && contact.FeatureID != 0)
+		{
+			if (aNewContact.FeatureID == contact.FeatureID)
+				return i;
+			continue;
+		}
+
+		vector3 offset = aNewContact.ContactPositionA_WS - contact.ContactPositionA_WS;
+		float distance = glm::dot(offset, offset);
+		if (distance < closestDistance)
+		{
+			closestDistance = distance;
+			closestPoint = i;
+		}
+	}
+	return closestPoint;
+}
+
+int ContactManifold::EliminateExtraContacts(const ContactData & aNewContact) const
+{
+	// The deepest point is the one most needed to push the shapes apart, unless the new one is deeper still
+	int deepestPoint = -1;
+	float maxDepth = aNewContact.PenetrationDepth;
+	for (int i = 0; i < Size; ++i)
+	{
+		if (ManifoldPoints[i].PenetrationDepth > maxDepth)
+		{
+			maxDepth = ManifoldPoints[i].PenetrationDepth;
+			deepestPoint = i;
+		}
+	}
+
+	int replacedPoint = 0;
+	float maxArea = -FLT_MAX;
+	for (int i = 0; i < 4; ++i)
+	{
+		if (i == deepestPoint)
+			continue;
+
+		vector3 points[4];
+		for (int j = 0; j < 4; ++j)
+			points[j] = (j == i) ? aNewContact.ContactPositionA_WS : ManifoldPoints[j].ContactPositionA_WS;
+		float area = GetQuadArea(points[0], points[1], points[2], points[3]);
+		if (area > maxArea)
+		{
+			maxArea = area;
+			replacedPoint = i;
+		}
+	}
+	return replacedPoint;
+}
+
+void ContactManifold::AddContact(const ContactData & aNewContact)
+{
+	ContactData newContact = aNewContact;
+	newContact.Lifetime = 0;
+	newContact.NormalImpulse = newContact.TangentImpulse1 = newContact.TangentImpulse2 = 0.0f;
+
+	int index = ValidateNewContact(aNewContact);
+	if (index >= 0)
+		InheritContact(newContact, ManifoldPoints[index]);
+	else if (Size < 4)
+		index = Size++;
+	else
+		index = EliminateExtraContacts(aNewContact);
+
+	ManifoldPoints[index] = newContact;
+}
+
+void ContactManifold::UpdateContacts(const ContactManifold & aNewManifold)
+{
+	// Each current point can only continue as one new point
+	ContactData newContacts[4];
+	unsigned int matchedMask = 0;
+	for (int i = 0; i < aNewManifold.Size; ++i)
+	{
+		newContacts[i] = aNewManifold.ManifoldPoints[i];
+		newContacts[i].Lifetime = 0;
+		newContacts[i].NormalImpulse = newContacts[i].TangentImpulse1 = newContacts[i].TangentImpulse2 = 0.0f;
+
+		int index = ValidateNewContact(aNewManifold.ManifoldPoints[i], matchedMask);
+		if (index >= 0)
+		{
+			InheritContact(newContacts[i], ManifoldPoints[index]);
+			matchedMask |= 1u << index;
+		}
+	}
+
+	Size = aNewManifold.Size;
+	for (int i = 0; i < Size; ++i)
+		ManifoldPoints[i] = newContacts[i];
+}
+
+void ContactManifold::StoreImpulses()
+{
+	for (int i = 0; i < Size; ++i)
+	{
+		if (pConstraints[i] == nullptr)
+			continue;
+		ManifoldPoints[i].NormalImpulse = pConstraints[i]->NormalImpulseSum;
+		ManifoldPoints[i].TangentImpulse1 = pConstraints[i]->TangentImpulseSum1;
+		ManifoldPoints[i].TangentImpulse2 = pConstraints[i]->TangentImpulseSum2;
+	}
+}
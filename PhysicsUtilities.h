@@ -2,6 +2,8 @@
 #include <algorithm>
 #include "Typedefs.h"
 
+class ContactConstraint;
+
 struct SupportPoint
 {
 	vector3 MinkowskiHullVertex;
@@ -68,17 +70,6 @@ struct PolytopeFace
 	}
 };
 
-struct PolytopeEdge
-{
-	SupportPoint Points[2];
-
-	PolytopeEdge(const SupportPoint & supportA, const SupportPoint & supportB)
-	{
-		Points[0] = supportA;
-		Points[1] = supportB;
-	}
-};
-
 struct ContactData
 {
 	// Contact point data - World Space
@@ -93,6 +84,18 @@ struct ContactData
 	vector3 Tangent1, Tangent2;
 
 	float PenetrationDepth;
+
+	// Pair of features (faces, edges, vertices) the point came from, used to recognize it next step, 0 if the narrowphase has none
+	unsigned int FeatureID = 0;
+	// Number of consecutive steps the point has been matched to one from the previous step
+	int Lifetime = 0;
+	// Accumulated impulses of the constraint solving the point at the end of the last step, used to warm start the next one
+	float NormalImpulse = 0.0f;
+	float TangentImpulse1 = 0.0f;
+	float TangentImpulse2 = 0.0f;
+
+	// Completes the basis from the normal, the same normal always gives the same tangents so the tangent impulses keep their direction between steps
+	void CalculateTangents();
 };
 
 
@@ -104,15 +107,33 @@ struct ContactManifold
 	int ConstraintID = 0; 
 	ContactData ManifoldPoints[4];
 	int Size = 0;
+	// Constraint solving each of the points, null past Size
+	ContactConstraint * pConstraints[4] = { nullptr, nullptr, nullptr, nullptr };
 
 	ContactData &a;
 	ContactData &b;
 	ContactData &c;
 	ContactData &d;
 
-	void ValidateAllContacts();
-	void ValidateNewContact();
-	void EliminateExtraContacts();
+	// Points closer than this are the same contact, and points that separate or slide by more than this are dropped
+	static constexpr float ContactBreakingThreshold = 0.02f;
+
+	// Recomputes the world positions and depth of every point from its local positions and the current model matrices,
+	// then drops the points that separated or slid along the surface since they were found. Returns the number dropped
+	int ValidateAllContacts(const matrix4 & aLocalToWorldA, const matrix4 & aLocalToWorldB);
+	// Index of the point aNewContact is a new measurement of, -1 if it is a new contact
+	// Matched by feature ID when both points have one, else by the closest world position within ContactBreakingThreshold
+	// Points whose bit is set in aExcludedMask are skipped
+	int ValidateNewContact(const ContactData & aNewContact, unsigned int aExcludedMask = 0) const;
+	// Index of the point aNewContact should replace in a full manifold, the deepest point is kept and
+	// of the remaining choices the one leaving the largest area is picked
+	int EliminateExtraContacts(const ContactData & aNewContact) const;
+	// Adds the single contact of an incremental narrowphase like GJK, over the point it matches if there is one
+	void AddContact(const ContactData & aNewContact);
+	// Replaces the points with the complete set from a pair kernel, the points that match one of the current ones carry on its lifetime
+	void UpdateContacts(const ContactManifold & aNewManifold);
+	// Copies the accumulated impulses of the constraints back into their points, so they follow the points matched next step
+	void StoreImpulses();
 
 	inline void Clear() { Size = 0; }
 	ContactManifold() :
@@ -140,6 +161,56 @@ struct ContactManifold
 	}
 };
 
+// World space axis aligned bounding box, used by the broadphase to cull pairs before running GJK
+struct AABB
+{
+	vector3 Min = vector3(0);
+	vector3 Max = vector3(0);
+
+	AABB() {}
+	AABB(vector3 aMin, vector3 aMax) : Min(aMin), Max(aMax) {}
+
+	inline bool Overlaps(const AABB & aOther) const
+	{
+		return (Min.x <= aOther.Max.x && Max.x >= aOther.Min.x) &&
+			   (Min.y <= aOther.Max.y && Max.y >= aOther.Min.y) &&
+			   (Min.z <= aOther.Max.z && Max.z >= aOther.Min.z);
+	}
+
+	inline bool Contains(const AABB & aOther) const
+	{
+		return (Min.x <= aOther.Min.x && Min.y <= aOther.Min.y && Min.z <= aOther.Min.z) &&
+			   (Max.x >= aOther.Max.x && Max.y >= aOther.Max.y && Max.z >= aOther.Max.z);
+	}
+
+	// Used as the cost metric of the surface area heuristic (SAH)
+	inline float SurfaceArea() const
+	{
+		vector3 size = Max - Min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	inline vector3 GetCenter() const { return (Min + Max) * 0.5f; }
+
+	// Smallest box enclosing both boxes
+	static inline AABB Merge(const AABB & aBoxA, const AABB & aBoxB)
+	{
+		return AABB(vector3(std::min(aBoxA.Min.x, aBoxB.Min.x), std::min(aBoxA.Min.y, aBoxB.Min.y), std::min(aBoxA.Min.z, aBoxB.Min.z)),
+					vector3(std::max(aBoxA.Max.x, aBoxB.Max.x), std::max(aBoxA.Max.y, aBoxB.Max.y), std::max(aBoxA.Max.z, aBoxB.Max.z)));
+	}
+};
+
+class Collider;
+// A pair of colliders whose bounds overlap, output of every broadphase mode
+// ColliderA always has the lower ColliderSlot so that the same pair is never reported in two different orders
+struct ColliderPair
+{
+	Collider * ColliderA;
+	Collider * ColliderB;
+
+	ColliderPair(Collider * aColliderA, Collider * aColliderB) : ColliderA(aColliderA), ColliderB(aColliderB) {}
+};
+
 struct Point
 {
 	vector3 position;
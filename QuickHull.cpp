@@ -0,0 +1,299 @@
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include "QuickHull.h"
+
+namespace
+{
+	struct BuildEdge
+	{
+		int Origin;
+		int Twin;
+		int Face;
+	};
+
+	struct BuildFace
+	{
+		vector3 Normal;
+		float Offset;
+		bool bIsRemoved;
+		// Points in front of this face that no other face has claimed yet
+		std::vector<int> OutsidePointList;
+	};
+
+	// Faces are never reused while building, the edges of face f are 3f, 3f + 1 and 3f + 2 here too
+	class HullBuilder
+	{
+	public:
+		HullBuilder(const std::vector<vector3> & aPoints) : Points(aPoints) {}
+
+		const std::vector<vector3> & Points;
+		float Tolerance = 0.0f;
+		std::vector<BuildEdge> EdgeList;
+		std::vector<BuildFace> FaceList;
+
+		static inline int GetNextEdge(int aEdge) { return (aEdge % 3 == 2) ? aEdge - 2 : aEdge + 1; }
+		inline int GetEndVertex(int aEdge) const { return EdgeList[GetNextEdge(aEdge)].Origin; }
+		inline float GetDistance(int aFace, int aPoint) const { return glm::dot(FaceList[aFace].Normal, Points[aPoint]) - FaceList[aFace].Offset; }
+
+		int AddFace(int aVertexA, int aVertexB, int aVertexC)
+		{
+			int face = (int)FaceList.size();
+			FaceList.emplace_back();
+			BuildFace & newFace = FaceList.back();
+			const vector3 & a = Points[aVertexA];
+			vector3 normal = glm::cross(Points[aVertexB] - a, Points[aVertexC] - a);
+			float length = glm::length(normal);
+			newFace.Normal = (length > 0.0f) ? normal / length : vector3(0);
+			newFace.Offset = glm::dot(newFace.Normal, a);
+			newFace.bIsRemoved = false;
+
+			EdgeList.push_back({ aVertexA, -1, face });
+			EdgeList.push_back({ aVertexB, -1, face });
+			EdgeList.push_back({ aVertexC, -1, face });
+			return face;
+		}
+
+		inline void LinkEdges(int aEdgeA, int aEdgeB)
+		{
+			EdgeList[aEdgeA].Twin = aEdgeB;
+			EdgeList[aEdgeB].Twin = aEdgeA;
+		}
+
+		// Gives each point to the first of the faces it is in front of, points behind all of them are inside the hull
+		void AssignPoint(int aPoint, int aFirstFace, int aLastFace)
+		{
+			for (int face = aFirstFace; face < aLastFace; ++face)
+			{
+				if (FaceList[face].bIsRemoved == false && GetDistance(face, aPoint) > Tolerance)
+				{
+					FaceList[face].OutsidePointList.push_back(aPoint);
+					return;
+				}
+			}
+		}
+
+		bool BuildInitialTetrahedron();
+		void AddPoint(int aFace, int aEyePoint);
+	};
+
+	bool HullBuilder::BuildInitialTetrahedron()
+	{
+		// The two extreme points along the axis with the largest spread
+		int minPoints[3] = { 0, 0, 0 };
+		int maxPoints[3] = { 0, 0, 0 };
+		vector3 maxAbsolute(0);
+		for (int i = 0; i < (int)Points.size(); ++i)
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				if (Points[i][axis] < Points[minPoints[axis]][axis])
+					minPoints[axis] = i;
+				if (Points[i][axis] > Points[maxPoints[axis]][axis])
+					maxPoints[axis] = i;
+				maxAbsolute[axis] = glm::max(maxAbsolute[axis], fabs(Points[i][axis]));
+			}
+		}
+		// Scale of the rounding error in plane distances, from qhull
+		Tolerance = 3.0f * FLT_EPSILON * (maxAbsolute.x + maxAbsolute.y + maxAbsolute.z);
+
+		int spreadAxis = 0;
+		for (int axis = 1; axis < 3; ++axis)
+		{
+			if (Points[maxPoints[axis]][axis] - Points[minPoints[axis]][axis] > Points[maxPoints[spreadAxis]][spreadAxis] - Points[minPoints[spreadAxis]][spreadAxis])
+				spreadAxis = axis;
+		}
+		int vertices[4] = { minPoints[spreadAxis], maxPoints[spreadAxis], -1, -1 };
+		if (glm::length(Points[vertices[1]] - Points[vertices[0]]) <= Tolerance)
+			return false;
+
+		// Farthest point from the line through them
+		vector3 lineDirection = glm::normalize(Points[vertices[1]] - Points[vertices[0]]);
+		float maxDistance = Tolerance;
+		for (int i = 0; i < (int)Points.size(); ++i)
+		{
+			float distance = glm::length(glm::cross(Points[i] - Points[vertices[0]], lineDirection));
+			if (distance > maxDistance)
+			{
+				maxDistance = distance;
+				vertices[2] = i;
+			}
+		}
+		if (vertices[2] < 0)
+			return false;
+
+		// Farthest point from the plane through the three of them
+		vector3 planeNormal = glm::normalize(glm::cross(Points[vertices[1]] - Points[vertices[0]], Points[vertices[2]] - Points[vertices[0]]));
+		maxDistance = Tolerance;
+		for (int i = 0; i < (int)Points.size(); ++i)
+		{
+			float distance = fabs(glm::dot(Points[i] - Points[vertices[0]], planeNormal));
+			if (distance > maxDistance)
+			{
+				maxDistance = distance;
+				vertices[3] = i;
+			}
+		}
+		if (vertices[3] < 0)
+			return false;
+
+		// Faces below are wound outwards only if the fourth vertex is behind the first face, as in ExpandingPolytope
+		if (glm::dot(Points[vertices[3]] - Points[vertices[0]], planeNormal) > 0.0f)
+			std::swap(vertices[0], vertices[1]);
+		const int tetrahedronFaces[4][3] = { { 0, 1, 2 }, { 0, 2, 3 }, { 0, 3, 1 }, { 1, 3, 2 } };
+		for (int i = 0; i < 4; ++i)
+			AddFace(vertices[tetrahedronFaces[i][0]], vertices[tetrahedronFaces[i][1]], vertices[tetrahedronFaces[i][2]]);
+
+		// Every edge of the tetrahedron is shared with the face that has it in the opposite direction
+		for (int edgeA = 0; edgeA < 12; ++edgeA)
+		{
+			for (int edgeB = 0; edgeB < 12; ++edgeB)
+			{
+				if (EdgeList[edgeA].Origin == GetEndVertex(edgeB) && GetEndVertex(edgeA) == EdgeList[edgeB].Origin)
+					EdgeList[edgeA].Twin = edgeB;
+			}
+		}
+
+		for (int i = 0; i < (int)Points.size(); ++i)
+			AssignPoint(i, 0, 4);
+		return true;
+	}
+
+	void HullBuilder::AddPoint(int aFace, int aEyePoint)
+	{
+		// Faces the eye point can see form a connected patch around aFace, its boundary is the horizon
+		std::vector<int> visibleFaceList(1, aFace);
+		std::vector<int> horizonEdgeList;
+		FaceList[aFace].bIsRemoved = true;
+		for (int i = 0; i < (int)visibleFaceList.size(); ++i)
+		{
+			for (int edge = 3 * visibleFaceList[i]; edge < 3 * visibleFaceList[i] + 3; ++edge)
+			{
+				int adjacentFace = EdgeList[EdgeList[edge].Twin].Face;
+				if (FaceList[adjacentFace].bIsRemoved)
+					continue;
+				if (GetDistance(adjacentFace, aEyePoint) > Tolerance)
+				{
+					FaceList[adjacentFace].bIsRemoved = true;
+					visibleFaceList.push_back(adjacentFace);
+				}
+				else
+					horizonEdgeList.push_back(edge);
+			}
+		}
+
+		// Walk the horizon in order, each edge ends where the next one starts
+		for (int i = 0; i + 1 < (int)horizonEdgeList.size(); ++i)
+		{
+			int endVertex = GetEndVertex(horizonEdgeList[i]);
+			for (int j = i + 1; j < (int)horizonEdgeList.size(); ++j)
+			{
+				if (EdgeList[horizonEdgeList[j]].Origin == endVertex)
+				{
+					std::swap(horizonEdgeList[i + 1], horizonEdgeList[j]);
+					break;
+				}
+			}
+		}
+
+		// Fan of new faces from each horizon edge to the eye point, each shares its second edge with the third edge of the next one
+		int firstNewFace = (int)FaceList.size();
+		int horizonSize = (int)horizonEdgeList.size();
+		for (int i = 0; i < horizonSize; ++i)
+		{
+			int horizonEdge = horizonEdgeList[i];
+			int outerEdge = EdgeList[horizonEdge].Twin;
+			int newFace = AddFace(EdgeList[horizonEdge].Origin, GetEndVertex(horizonEdge), aEyePoint);
+			LinkEdges(3 * newFace, outerEdge);
+			if (i > 0)
+				LinkEdges(3 * (newFace - 1) + 1, 3 * newFace + 2);
+		}
+		LinkEdges(3 * (firstNewFace + horizonSize - 1) + 1, 3 * firstNewFace + 2);
+
+		// Points that were outside the removed faces are either outside a new face or now inside the hull
+		int lastNewFace = (int)FaceList.size();
+		for (int visibleFace : visibleFaceList)
+		{
+			std::vector<int> outsidePointList = std::move(FaceList[visibleFace].OutsidePointList);
+			FaceList[visibleFace].OutsidePointList.clear();
+			for (int point : outsidePointList)
+			{
+				if (point != aEyePoint)
+					AssignPoint(point, firstNewFace, lastNewFace);
+			}
+		}
+	}
+}
+
+bool QuickHull::Build(const std::vector<vector3> & aPoints, HalfEdgeMesh & aMesh)
+{
+	aMesh.Clear();
+	if (aPoints.size() < 4)
+		return false;
+
+	HullBuilder builder(aPoints);
+	if (builder.BuildInitialTetrahedron() == false)
+		return false;
+
+	// New faces are appended, so a single pass in order reaches every face that still has points outside it
+	for (int face = 0; face < (int)builder.FaceList.size(); ++face)
+	{
+		BuildFace & currentFace = builder.FaceList[face];
+		if (currentFace.bIsRemoved || currentFace.OutsidePointList.empty())
+			continue;
+
+		int eyePoint = currentFace.OutsidePointList[0];
+		float maxDistance = builder.GetDistance(face, eyePoint);
+		for (int point : currentFace.OutsidePointList)
+		{
+			float distance = builder.GetDistance(face, point);
+			if (distance > maxDistance)
+			{
+				maxDistance = distance;
+				eyePoint = point;
+			}
+		}
+		builder.AddPoint(face, eyePoint);
+	}
+
+	// Copy the faces that are left, with the vertices they use, into contiguous arrays
+	std::vector<int> newFaceIndices(builder.FaceList.size(), -1);
+	std::vector<int> newVertexIndices(aPoints.size(), -1);
+	int faceCount = 0;
+	for (int face = 0; face < (int)builder.FaceList.size(); ++face)
+	{
+		if (builder.FaceList[face].bIsRemoved == false)
+			newFaceIndices[face] = faceCount++;
+	}
+	if (3 * faceCount > HalfEdgeMesh::MaxIndex)
+		return false;
+
+	aMesh.EdgeList.resize(3 * faceCount);
+	aMesh.FacePlaneList.resize(faceCount);
+	for (int face = 0; face < (int)builder.FaceList.size(); ++face)
+	{
+		int newFace = newFaceIndices[face];
+		if (newFace < 0)
+			continue;
+		aMesh.FacePlaneList[newFace].Normal = builder.FaceList[face].Normal;
+		aMesh.FacePlaneList[newFace].Offset = builder.FaceList[face].Offset;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			const BuildEdge & edge = builder.EdgeList[3 * face + i];
+			if (newVertexIndices[edge.Origin] < 0)
+			{
+				newVertexIndices[edge.Origin] = (int)aMesh.VertexList.size();
+				aMesh.VertexList.push_back(aPoints[edge.Origin]);
+				aMesh.VertexEdgeList.push_back((unsigned short)(3 * newFace + i));
+			}
+
+			HalfEdgeMesh::HalfEdge & newEdge = aMesh.EdgeList[3 * newFace + i];
+			newEdge.Origin = (unsigned short)newVertexIndices[edge.Origin];
+			newEdge.Twin = (unsigned short)(3 * newFaceIndices[edge.Twin / 3] + edge.Twin % 3);
+			newEdge.Next = (unsigned short)(3 * newFace + (i + 1) % 3);
+			newEdge.Face = (unsigned short)newFace;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include "Typedefs.h"
+
+// Convex polyhedron stored as half-edges, faces are triangles wound counter clockwise seen from outside
+// Indices are 16 bits to keep the structure small, the edges of face f are 3f, 3f + 1 and 3f + 2
+struct HalfEdgeMesh
+{
+	struct HalfEdge
+	{
+		// Vertex the edge starts from
+		unsigned short Origin;
+		// Same edge going the other way, on the adjacent face
+		unsigned short Twin;
+		// Next edge counter clockwise around the face
+		unsigned short Next;
+		unsigned short Face;
+	};
+	struct Plane
+	{
+		// Unit length, pointing out of the hull
+		vector3 Normal;
+		float Offset;
+	};
+
+	static const int MaxIndex = 0xFFFF;
+
+	std::vector<vector3> VertexList;
+	// One edge starting from each vertex, the others are found by walking Twin then Next
+	std::vector<unsigned short> VertexEdgeList;
+	std::vector<HalfEdge> EdgeList;
+	std::vector<Plane> FacePlaneList;
+
+	inline int GetFaceCount() const { return (int)FacePlaneList.size(); }
+	inline void Clear()
+	{
+		VertexList.clear();
+		VertexEdgeList.clear();
+		EdgeList.clear();
+		FacePlaneList.clear();
+	}
+};
+
+// Quickhull, C. Bradford Barber, David P. Dobkin, Hannu Huhdanpaa - The Quickhull Algorithm for Convex Hulls (1996)
+// Starts from the largest tetrahedron of extreme points, then repeatedly adds the farthest point outside a face and
+// replaces every face that point can see with a fan of faces joining it to the horizon. Points within a tolerance
+// of the hull are treated as inside, so duplicated and coplanar mesh vertices don't create degenerate faces.
+namespace QuickHull
+{
+	// Returns false and leaves aMesh empty if the points are all coplanar, or the hull needs more than 16 bit indices
+	bool Build(const std::vector<vector3> & aPoints, HalfEdgeMesh & aMesh);
+}
@@ -0,0 +1,218 @@
+#include <cfloat>
+#include <cmath>
+#include "RoundShapeCollision.h"
+
+namespace
+{
+	// Used when the inner features touch and there is no direction between them
+	const vector3 DefaultNormal = vector3(0.0f, 1.0f, 0.0f);
+
+	inline vector3 GetClosestPointOnSegment(const vector3 & aPoint, const vector3 & aStart, const vector3 & aEnd)
+	{
+		vector3 segment = aEnd - aStart;
+		float lengthSquared = glm::dot(segment, segment);
+		if (lengthSquared <= 0.0f)
+			return aStart;
+		float t = glm::clamp(glm::dot(aPoint - aStart, segment) / lengthSquared, 0.0f, 1.0f);
+		return aStart + t * segment;
+	}
+
+	// Real-Time Collision Detection 5.1.9, degenerate segments are handled as points
+	void GetClosestPointsBetweenSegments(const vector3 & aStartA, const vector3 & aEndA, const vector3 & aStartB, const vector3 & aEndB, vector3 & aPointA, vector3 & aPointB)
+	{
+		vector3 directionA = aEndA - aStartA;
+		vector3 directionB = aEndB - aStartB;
+		vector3 offset = aStartA - aStartB;
+		float a = glm::dot(directionA, directionA);
+		float e = glm::dot(directionB, directionB);
+		float f = glm::dot(directionB, offset);
+
+		float s = 0.0f, t = 0.0f;
+		if (a <= FLT_EPSILON && e <= FLT_EPSILON)
+		{
+			// Both segments are points
+		}
+		else if (a <= FLT_EPSILON)
+		{
+			t = glm::clamp(f / e, 0.0f, 1.0f);
+		}
+		else
+		{
+			float c = glm::dot(directionA, offset);
+			if (e <= FLT_EPSILON)
+			{
+				s = glm::clamp(-c / a, 0.0f, 1.0f);
+			}
+			else
+			{
+				float b = glm::dot(directionA, directionB);
+				float denominator = a * e - b * b;
+				// Parallel segments have no unique closest points, any s works so start from the start of A
+				if (denominator > 0.0f)
+					s = glm::clamp((b * f - c * e) / denominator, 0.0f, 1.0f);
+				t = (b * s + f) / e;
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = glm::clamp(-c / a, 0.0f, 1.0f);
+				}
+				else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+				}
+			}
+		}
+		aPointA = aStartA + s * directionA;
+		aPointB = aStartB + t * directionB;
+	}
+
+	inline void SetContact(ContactData & aContact, const matrix4 & aLocalToWorldA, const matrix4 & aLocalToWorldB, const vector3 & aPointA, const vector3 & aPointB, const vector3 & aNormal, float aDepth)
+	{
+		aContact.ContactPositionA_WS = aPointA;
+		aContact.ContactPositionB_WS = aPointB;
+		aContact.ContactPositionA_LS = vector3(glm::inverse(aLocalToWorldA) * vector4(aPointA, 1));
+		aContact.ContactPositionB_LS = vector3(glm::inverse(aLocalToWorldB) * vector4(aPointB, 1));
+		aContact.Normal = aNormal;
+		aContact.PenetrationDepth = aDepth;
+	}
+
+	// Adds the contact between spheres around the two inner points if they overlap
+	bool AddSphereContact(ContactManifold & aManifold, const Collider & aColliderA, const Collider & aColliderB,
+		const vector3 & aCenterA, float aRadiusA, const vector3 & aCenterB, float aRadiusB, const vector3 & aFallbackNormal)
+	{
+		vector3 offset = aCenterB - aCenterA;
+		float distanceSquared = glm::dot(offset, offset);
+		float radiusSum = aRadiusA + aRadiusB;
+		if (distanceSquared > radiusSum * radiusSum)
+			return false;
+
+		float distance = sqrtf(distanceSquared);
+		vector3 normal = (distance > FLT_EPSILON) ? offset / distance : aFallbackNormal;
+		SetContact(aManifold.ManifoldPoints[aManifold.Size], aColliderA.LocalToWorldMatrix, aColliderB.LocalToWorldMatrix,
+			aCenterA + aRadiusA * normal, aCenterB - aRadiusB * normal, normal, radiusSum - distance);
+		++aManifold.Size;
+		return true;
+	}
+}
+
+bool RoundShapeCollision::Collide(Sphere & aSphereA, Sphere & aSphereB, ContactManifold & aManifold)
+{
+	aManifold.Clear();
+	return AddSphereContact(aManifold, aSphereA, aSphereB, aSphereA.GetWorldCenter(), aSphereA.GetWorldRadius(), aSphereB.GetWorldCenter(), aSphereB.GetWorldRadius(), DefaultNormal);
+}
+
+bool RoundShapeCollision::Collide(Sphere & aSphere, Capsule & aCapsule, ContactManifold & aManifold)
+{
+	aManifold.Clear();
+	vector3 center = aSphere.GetWorldCenter();
+	vector3 start, end;
+	aCapsule.GetWorldSegment(start, end);
+	vector3 closestPoint = GetClosestPointOnSegment(center, start, end);
+	return AddSphereContact(aManifold, aSphere, aCapsule, center, aSphere.GetWorldRadius(), closestPoint, aCapsule.GetWorldRadius(), DefaultNormal);
+}
+
+bool RoundShapeCollision::Collide(Capsule & aCapsuleA, Capsule & aCapsuleB, ContactManifold & aManifold)
+{
+	aManifold.Clear();
+	vector3 startA, endA, startB, endB;
+	aCapsuleA.GetWorldSegment(startA, endA);
+	aCapsuleB.GetWorldSegment(startB, endB);
+	float radiusA = aCapsuleA.GetWorldRadius();
+	float radiusB = aCapsuleB.GetWorldRadius();
+
+	// Crossing segments have no direction between their closest points, their common normal separates them instead
+	vector3 directionA = endA - startA;
+	vector3 directionB = endB - startB;
+	vector3 fallbackNormal = glm::cross(directionA, directionB);
+	float crossLengthSquared = glm::dot(fallbackNormal, fallbackNormal);
+	float lengthSquaredA = glm::dot(directionA, directionA);
+	float lengthSquaredB = glm::dot(directionB, directionB);
+	bool bAreParallel = crossLengthSquared <= 1e-6f * lengthSquaredA * lengthSquaredB;
+	if (bAreParallel)
+	{
+		fallbackNormal = DefaultNormal;
+	}
+	else
+	{
+		fallbackNormal /= sqrtf(crossLengthSquared);
+		if (glm::dot(fallbackNormal, vector3(aCapsuleB.LocalToWorldMatrix[3]) - vector3(aCapsuleA.LocalToWorldMatrix[3])) < 0.0f)
+			fallbackNormal = -fallbackNormal;
+	}
+
+	if (bAreParallel && lengthSquaredA > FLT_EPSILON)
+	{
+		// Range of A covered by the projection of B
+		float projectionStart = glm::dot(startB - startA, directionA) / lengthSquaredA;
+		float projectionEnd = glm::dot(endB - startA, directionA) / lengthSquaredA;
+		float overlapStart = glm::max(0.0f, glm::min(projectionStart, projectionEnd));
+		float overlapEnd = glm::min(1.0f, glm::max(projectionStart, projectionEnd));
+		if (overlapStart < overlapEnd)
+		{
+			vector3 pointA1 = startA + overlapStart * directionA;
+			vector3 pointA2 = startA + overlapEnd * directionA;
+			AddSphereContact(aManifold, aCapsuleA, aCapsuleB, pointA1, radiusA, GetClosestPointOnSegment(pointA1, startB, endB), radiusB, fallbackNormal);
+			AddSphereContact(aManifold, aCapsuleA, aCapsuleB, pointA2, radiusA, GetClosestPointOnSegment(pointA2, startB, endB), radiusB, fallbackNormal);
+			return aManifold.Size > 0;
+		}
+	}
+
+	vector3 pointA, pointB;
+	GetClosestPointsBetweenSegments(startA, endA, startB, endB, pointA, pointB);
+	return AddSphereContact(aManifold, aCapsuleA, aCapsuleB, pointA, radiusA, pointB, radiusB, fallbackNormal);
+}
+
+bool RoundShapeCollision::Collide(Sphere & aSphere, Box & aBox, ContactManifold & aManifold)
+{
+	aManifold.Clear();
+	vector3 center = aSphere.GetWorldCenter();
+	float radius = aSphere.GetWorldRadius();
+
+	// Sphere center in the frame of the box, with world space units
+	vector3 boxCenter(aBox.LocalToWorldMatrix[3]);
+	vector3 axes[3];
+	vector3 halfExtents;
+	vector3 localCenter;
+	for (int i = 0; i < 3; ++i)
+	{
+		vector3 column(aBox.LocalToWorldMatrix[i]);
+		float scale = glm::length(column);
+		axes[i] = column / scale;
+		halfExtents[i] = aBox.HalfSize[i] * scale;
+		localCenter[i] = glm::dot(center - boxCenter, axes[i]);
+	}
+
+	vector3 clampedCenter = glm::min(glm::max(localCenter, -halfExtents), halfExtents);
+	vector3 closestPoint = boxCenter + clampedCenter.x * axes[0] + clampedCenter.y * axes[1] + clampedCenter.z * axes[2];
+	if (clampedCenter != localCenter)
+	{
+		// Center outside the box, the closest point on the box is the deepest point of the contact on it
+		vector3 offset = closestPoint - center;
+		float distanceSquared = glm::dot(offset, offset);
+		if (distanceSquared > radius * radius)
+			return false;
+		float distance = sqrtf(distanceSquared);
+		vector3 normal = (distance > FLT_EPSILON) ? offset / distance : DefaultNormal;
+		SetContact(aManifold.ManifoldPoints[0], aSphere.LocalToWorldMatrix, aBox.LocalToWorldMatrix, center + radius * normal, closestPoint, normal, radius - distance);
+		aManifold.Size = 1;
+		return true;
+	}
+
+	// Center inside the box, the sphere gets pushed out through the closest face
+	int faceAxis = 0;
+	float faceDistance = FLT_MAX;
+	for (int i = 0; i < 3; ++i)
+	{
+		float distance = halfExtents[i] - fabs(localCenter[i]);
+		if (distance < faceDistance)
+		{
+			faceDistance = distance;
+			faceAxis = i;
+		}
+	}
+	vector3 outward = (localCenter[faceAxis] < 0.0f) ? -axes[faceAxis] : axes[faceAxis];
+	vector3 normal = -outward;
+	SetContact(aManifold.ManifoldPoints[0], aSphere.LocalToWorldMatrix, aBox.LocalToWorldMatrix, center + radius * normal, center + faceDistance * outward, normal, radius + faceDistance);
+	aManifold.Size = 1;
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "PhysicsUtilities.h"
+#include "NarrowphaseDispatch.h"
+#include "Box.h"
+#include "Sphere.h"
+#include "Capsule.h"
+
+// Closed form contacts for spheres and capsules, which are a point or a segment with a radius around it
+// The closest points between the inner point or segment of each shape give the normal, the contact is an overlap of the radii
+// Real-Time Collision Detection, 5.1.9 : Closest Points of Two Line Segments, and 5.2.5 : Testing Sphere Against OBB
+// Model matrices must be up to date, contact normals point from the first shape to the second like the ones from EPA
+namespace RoundShapeCollision
+{
+	bool Collide(Sphere & aSphereA, Sphere & aSphereB, ContactManifold & aManifold);
+	bool Collide(Sphere & aSphere, Capsule & aCapsule, ContactManifold & aManifold);
+	// Parallel capsules whose segments overlap get a contact at each end of the overlap so they can rest on each other
+	bool Collide(Capsule & aCapsuleA, Capsule & aCapsuleB, ContactManifold & aManifold);
+	bool Collide(Sphere & aSphere, Box & aBox, ContactManifold & aManifold);
+}
+
+namespace NarrowphaseDispatch
+{
+	template <>
+	struct PairKernel<Collider::SPHERE, Collider::SPHERE>
+	{
+		static const bool bIsDefined = true;
+		static inline bool Collide(Collider & aColliderA, Collider & aColliderB, ContactManifold & aManifold)
+		{
+			return RoundShapeCollision::Collide(static_cast<Sphere &>(aColliderA), static_cast<Sphere &>(aColliderB), aManifold);
+		}
+	};
+
+	template <>
+	struct PairKernel<Collider::SPHERE, Collider::CAPSULE>
+	{
+		static const bool bIsDefined = true;
+		static inline bool Collide(Collider & aColliderA, Collider & aColliderB, ContactManifold & aManifold)
+		{
+			return RoundShapeCollision::Collide(static_cast<Sphere &>(aColliderA), static_cast<Capsule &>(aColliderB), aManifold);
+		}
+	};
+
+	template <>
+	struct PairKernel<Collider::CAPSULE, Collider::CAPSULE>
+	{
+		static const bool bIsDefined = true;
+		static inline bool Collide(Collider & aColliderA, Collider & aColliderB, ContactManifold & aManifold)
+		{
+			return RoundShapeCollision::Collide(static_cast<Capsule &>(aColliderA), static_cast<Capsule &>(aColliderB), aManifold);
+		}
+	};
+
+	template <>
+	struct PairKernel<Collider::SPHERE, Collider::BOX>
+	{
+		static const bool bIsDefined = true;
+		static inline bool Collide(Collider & aColliderA, Collider & aColliderB, ContactManifold & aManifold)
+		{
+			return RoundShapeCollision::Collide(static_cast<Sphere &>(aColliderA), static_cast<Box &>(aColliderB), aManifold);
+		}
+	};
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "Typedefs.h"
+
+// Widest instruction set the compiler is targeting, AVX processes a whole batch at once, SSE four lanes at a time
+// Anything else, or defining PHYSICS_SIMD_DISABLED, falls back to scalar loops which the compiler is still free to vectorize
+#if !defined(PHYSICS_SIMD_DISABLED)
+	#if defined(__AVX__)
+		#define PHYSICS_SIMD_AVX
+	#endif
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#define PHYSICS_SIMD_SSE
+	#endif
+	// Kernels that are picked at runtime by GetSupportedInstructionSet are compiled for AVX2 on any x64 target
+	// whatever the compiler is targeting, and must only be called once the CPU is known to support it
+	#if defined(_M_X64) || defined(__x86_64__)
+		#define PHYSICS_SIMD_AVX2_RUNTIME
+	#endif
+#endif
+
+#if defined(PHYSICS_SIMD_AVX) || defined(PHYSICS_SIMD_AVX2_RUNTIME)
+	#include <immintrin.h>
+#elif defined(PHYSICS_SIMD_SSE)
+	#include <emmintrin.h>
+#endif
+
+#if defined(PHYSICS_SIMD_AVX2_RUNTIME)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define PHYSICS_SIMD_TARGET_AVX2
+	#else
+		#define PHYSICS_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+// Vectors stored as separate arrays of x, y and z (SoA), so each SIMD lane works on a different vector
+struct alignas(32) Vector3Batch
+{
+	static const int Size = 8;
+	float X[Size];
+	float Y[Size];
+	float Z[Size];
+
+	inline void Set(int aIndex, const vector3 & aVector)
+	{
+		X[aIndex] = aVector.x;
+		Y[aIndex] = aVector.y;
+		Z[aIndex] = aVector.z;
+	}
+	inline vector3 Get(int aIndex) const { return vector3(X[aIndex], Y[aIndex], Z[aIndex]); }
+};
+
+namespace SIMD
+{
+	// Kernels chosen at runtime, ordered from narrowest to widest
+	enum InstructionSet
+	{
+		// Lane by lane with the scalar code, the reference the others are validated against
+		SCALAR,
+		// 4 lanes at a time
+		SSE,
+		// 8 lanes at a time
+		AVX2,
+		InstructionSetCount
+	};
+
+	inline const char * GetInstructionSetName(InstructionSet aInstructionSet)
+	{
+		static const char * names[InstructionSetCount] = { "Scalar Reference", "SSE (4 lanes)", "AVX2 (8 lanes)" };
+		return names[aInstructionSet];
+	}
+
+	// Widest instruction set both this build and the CPU running it support, detected once
+	inline InstructionSet GetSupportedInstructionSet()
+	{
+		static const InstructionSet supported = []()
+		{
+#if defined(PHYSICS_SIMD_AVX2_RUNTIME)
+	#if defined(_MSC_VER)
+			int registers[4];
+			__cpuid(registers, 0);
+			if (registers[0] >= 7)
+			{
+				__cpuid(registers, 1);
+				// The OS must save the YMM registers (OSXSAVE, then XCR0 bits 1 and 2) on top of the CPU having AVX
+				bool bHasAVX = (registers[2] & (1 << 28)) && (registers[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+				__cpuidex(registers, 7, 0);
+				if (bHasAVX && (registers[1] & (1 << 5)))
+					return AVX2;
+			}
+	#else
+			if (__builtin_cpu_supports("avx2"))
+				return AVX2;
+	#endif
+#endif
+#if defined(PHYSICS_SIMD_SSE)
+			return SSE;
+#else
+			return SCALAR;
+#endif
+		}();
+		return supported;
+	}
+
+	// aOut[i] = aMatrix * aIn[i] + aOffset for the first aCount lanes, aMatrix is column major like glm
+	// Lanes are processed in groups of 4, so the lanes up to the next multiple of 4 are transformed too and must hold finite values
+	inline void Transform(const matrix3 & aMatrix, const vector3 & aOffset, const Vector3Batch & aIn, Vector3Batch & aOut, int aCount = Vector3Batch::Size)
+	{
+#if defined(PHYSICS_SIMD_AVX)
+		if (aCount > 4)
+		{
+			__m256 x = _mm256_load_ps(aIn.X);
+			__m256 y = _mm256_load_ps(aIn.Y);
+			__m256 z = _mm256_load_ps(aIn.Z);
+			for (int row = 0; row < 3; ++row)
+			{
+				__m256 result = _mm256_set1_ps(aOffset[row]);
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_set1_ps(aMatrix[0][row]), x));
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_set1_ps(aMatrix[1][row]), y));
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_set1_ps(aMatrix[2][row]), z));
+				_mm256_store_ps((row == 0) ? aOut.X : (row == 1) ? aOut.Y : aOut.Z, result);
+			}
+			return;
+		}
+#endif
+#if defined(PHYSICS_SIMD_SSE) || defined(PHYSICS_SIMD_AVX)
+		for (int lane = 0; lane < aCount; lane += 4)
+		{
+			__m128 x = _mm_load_ps(aIn.X + lane);
+			__m128 y = _mm_load_ps(aIn.Y + lane);
+			__m128 z = _mm_load_ps(aIn.Z + lane);
+			for (int row = 0; row < 3; ++row)
+			{
+				__m128 result = _mm_set1_ps(aOffset[row]);
+				result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(aMatrix[0][row]), x));
+				result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(aMatrix[1][row]), y));
+				result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(aMatrix[2][row]), z));
+				_mm_store_ps(((row == 0) ? aOut.X : (row == 1) ? aOut.Y : aOut.Z) + lane, result);
+			}
+		}
+#else
+		for (int lane = 0; lane < aCount; ++lane)
+		{
+			vector3 result = aMatrix * aIn.Get(lane) + aOffset;
+			aOut.Set(lane, result);
+		}
+#endif
+	}
+}
@@ -0,0 +1,290 @@
+#include <cmath>
+#include <limits>
+#include "SignedVolumesGJK.h"
+#include "Collider.h"
+
+namespace
+{
+	// Zero never matches, so degenerate sub-simplices are always discarded
+	inline bool CompareSigns(float aA, float aB)
+	{
+		return (aA > 0.0f && aB > 0.0f) || (aA < 0.0f && aB < 0.0f);
+	}
+
+	inline int GetLargestAxis(const vector3 & aVector)
+	{
+		int axis = 0;
+		if (fabs(aVector.y) > fabs(aVector[axis]))
+			axis = 1;
+		if (fabs(aVector.z) > fabs(aVector[axis]))
+			axis = 2;
+		return axis;
+	}
+
+	inline float SignedVolume(const vector3 & aA, const vector3 & aB, const vector3 & aC, const vector3 & aD)
+	{
+		return glm::dot(aB - aA, glm::cross(aC - aA, aD - aA));
+	}
+}
+
+SupportPoint SignedVolumesGJK::Support(Collider * aColliderA, Collider * aColliderB, const vector3 & aDirection, bool aUseCoreShapes)
+{
+	SupportPoint supportPoint;
+	if (aUseCoreShapes)
+	{
+		supportPoint.Local_SupportPointA = aColliderA->FindFarthestCorePointInDirection(aDirection);
+		supportPoint.Local_SupportPointB = aColliderB->FindFarthestCorePointInDirection(-aDirection);
+	}
+	else
+	{
+		supportPoint.Local_SupportPointA = aColliderA->FindFarthestPointInDirection(aDirection);
+		supportPoint.Local_SupportPointB = aColliderB->FindFarthestPointInDirection(-aDirection);
+	}
+	supportPoint.World_SupportPointA = vector3(aColliderA->LocalToWorldMatrix * glm::vec4(supportPoint.Local_SupportPointA, 1));
+	supportPoint.World_SupportPointB = vector3(aColliderB->LocalToWorldMatrix * glm::vec4(supportPoint.Local_SupportPointB, 1));
+	supportPoint.MinkowskiHullVertex = supportPoint.World_SupportPointA - supportPoint.World_SupportPointB;
+	return supportPoint;
+}
+
+SignedVolumesGJK::DistanceResult SignedVolumesGJK::ComputeDistance(Collider * aColliderA, Collider * aColliderB, bool aUseCoreShapes) const
+{
+	DistanceResult result;
+
+	SupportPoint simplex[4];
+	vector3 vertices[4];
+	float weights[4] = { 1.0f, 0.0f, 0.0f, 0.0f };
+	int size = 0;
+
+	// Start searching along the line between the two centers
+	vector3 closestPoint = vector3(aColliderA->LocalToWorldMatrix[3]) - vector3(aColliderB->LocalToWorldMatrix[3]);
+	if (glm::dot(closestPoint, closestPoint) <= AbsoluteTolerance)
+		closestPoint = vector3(1, 0, 0);
+
+	while (result.IterationCount < IterationLimit)
+	{
+		SupportPoint newSupportPoint = Support(aColliderA, aColliderB, -closestPoint, aUseCoreShapes);
+		++result.IterationCount;
+
+		// |v|^2 - v.w is an upper bound of how far |v|^2 is from the real squared distance
+		float distanceSquared = glm::dot(closestPoint, closestPoint);
+		if (size > 0 && distanceSquared - glm::dot(closestPoint, newSupportPoint.MinkowskiHullVertex) <= RelativeTolerance * distanceSquared)
+			break;
+
+		// A point that is already in the simplex means no more progress can be made
+		bool bIsDuplicate = false;
+		for (int i = 0; i < size; ++i)
+			bIsDuplicate |= (vertices[i] == newSupportPoint.MinkowskiHullVertex);
+		if (bIsDuplicate)
+			break;
+
+		simplex[size] = newSupportPoint;
+		vertices[size] = newSupportPoint.MinkowskiHullVertex;
+		++size;
+
+		int resultIndices[4];
+		float resultWeights[4];
+		int resultSize = 0;
+		switch (size)
+		{
+			case 1:
+				resultIndices[0] = 0;
+				resultWeights[0] = 1.0f;
+				resultSize = 1;
+				break;
+			case 2:
+				resultSize = SolveSegment(vertices, 0, 1, resultIndices, resultWeights);
+				break;
+			case 3:
+				resultSize = SolveTriangle(vertices, 0, 1, 2, resultIndices, resultWeights);
+				break;
+			case 4:
+				resultSize = SolveTetrahedron(vertices, resultIndices, resultWeights);
+				break;
+		}
+
+		// Keep only the sub-simplex that supports the closest point
+		SupportPoint reducedSimplex[4];
+		for (int i = 0; i < resultSize; ++i)
+			reducedSimplex[i] = simplex[resultIndices[i]];
+		closestPoint = vector3(0);
+		for (int i = 0; i < resultSize; ++i)
+		{
+			simplex[i] = reducedSimplex[i];
+			vertices[i] = simplex[i].MinkowskiHullVertex;
+			weights[i] = resultWeights[i];
+			closestPoint += weights[i] * vertices[i];
+		}
+		size = resultSize;
+
+		// The origin is inside the tetrahedron, or close enough to the simplex to be touching
+		if (size == 4 || glm::dot(closestPoint, closestPoint) <= AbsoluteTolerance)
+		{
+			result.bIsIntersecting = true;
+			return result;
+		}
+	}
+
+	// Closest points are the same combination of support points as the closest point on the Minkowski difference
+	result.ClosestPointA = vector3(0);
+	result.ClosestPointB = vector3(0);
+	for (int i = 0; i < size; ++i)
+	{
+		result.ClosestPointA += weights[i] * simplex[i].World_SupportPointA;
+		result.ClosestPointB += weights[i] * simplex[i].World_SupportPointB;
+	}
+	result.Distance = glm::length(closestPoint);
+	return result;
+}
+
+int SignedVolumesGJK::SolveSegment(const vector3 * aPoints, int aIndex1, int aIndex2, int * aResultIndices, float * aResultWeights)
+{
+	const vector3 & s1 = aPoints[aIndex1];
+	const vector3 & s2 = aPoints[aIndex2];
+	vector3 segment = s2 - s1;
+	float lengthSquared = glm::dot(segment, segment);
+	if (lengthSquared <= 0.0f)
+	{
+		aResultIndices[0] = aIndex1;
+		aResultWeights[0] = 1.0f;
+		return 1;
+	}
+
+	// Projection of the origin onto the line, compared along the axis where the segment is longest
+	vector3 projection = s1 - (glm::dot(s1, segment) / lengthSquared) * segment;
+	int axis = GetLargestAxis(segment);
+	float length = s1[axis] - s2[axis];
+	float c1 = projection[axis] - s2[axis];
+	float c2 = s1[axis] - projection[axis];
+
+	if (CompareSigns(length, c1) && CompareSigns(length, c2))
+	{
+		aResultIndices[0] = aIndex1;
+		aResultIndices[1] = aIndex2;
+		aResultWeights[0] = c1 / length;
+		aResultWeights[1] = c2 / length;
+		return 2;
+	}
+	// The projection is past one of the end points, that end point is closest
+	aResultIndices[0] = CompareSigns(length, c2) ? aIndex2 : aIndex1;
+	aResultWeights[0] = 1.0f;
+	return 1;
+}
+
+int SignedVolumesGJK::SolveTriangle(const vector3 * aPoints, int aIndex1, int aIndex2, int aIndex3, int * aResultIndices, float * aResultWeights)
+{
+	const int indices[3] = { aIndex1, aIndex2, aIndex3 };
+	const vector3 & s1 = aPoints[aIndex1];
+	const vector3 & s2 = aPoints[aIndex2];
+	const vector3 & s3 = aPoints[aIndex3];
+	vector3 normal = glm::cross(s2 - s1, s3 - s1);
+	float normalLengthSquared = glm::dot(normal, normal);
+
+	float areas[3] = { 0.0f, 0.0f, 0.0f };
+	float area = 0.0f;
+	if (normalLengthSquared > 0.0f)
+	{
+		// Projection of the origin onto the plane, compared on the axis aligned plane where the triangle is largest
+		vector3 projection = (glm::dot(s1, normal) / normalLengthSquared) * normal;
+		int dropAxis = GetLargestAxis(normal);
+		int x = (dropAxis + 1) % 3;
+		int y = (dropAxis + 2) % 3;
+		auto signedArea = [x, y](const vector3 & aA, const vector3 & aB, const vector3 & aC)
+		{
+			return (aB[x] - aA[x]) * (aC[y] - aA[y]) - (aB[y] - aA[y]) * (aC[x] - aA[x]);
+		};
+		area = signedArea(s1, s2, s3);
+		areas[0] = signedArea(projection, s2, s3);
+		areas[1] = signedArea(s1, projection, s3);
+		areas[2] = signedArea(s1, s2, projection);
+
+		if (CompareSigns(area, areas[0]) && CompareSigns(area, areas[1]) && CompareSigns(area, areas[2]))
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				aResultIndices[i] = indices[i];
+				aResultWeights[i] = areas[i] / area;
+			}
+			return 3;
+		}
+	}
+
+	// The closest point is on one of the edges facing the origin, keep the closest of them
+	int bestSize = 0;
+	float bestDistanceSquared = std::numeric_limits<float>::max();
+	for (int i = 0; i < 3; ++i)
+	{
+		if (normalLengthSquared > 0.0f && CompareSigns(area, areas[i]))
+			continue;
+
+		int edgeIndices[2];
+		float edgeWeights[2];
+		int edgeSize = SolveSegment(aPoints, indices[(i + 1) % 3], indices[(i + 2) % 3], edgeIndices, edgeWeights);
+		vector3 closestPoint(0);
+		for (int j = 0; j < edgeSize; ++j)
+			closestPoint += edgeWeights[j] * aPoints[edgeIndices[j]];
+
+		float distanceSquared = glm::dot(closestPoint, closestPoint);
+		if (distanceSquared < bestDistanceSquared)
+		{
+			bestDistanceSquared = distanceSquared;
+			bestSize = edgeSize;
+			for (int j = 0; j < edgeSize; ++j)
+			{
+				aResultIndices[j] = edgeIndices[j];
+				aResultWeights[j] = edgeWeights[j];
+			}
+		}
+	}
+	return bestSize;
+}
+
+int SignedVolumesGJK::SolveTetrahedron(const vector3 * aPoints, int * aResultIndices, float * aResultWeights)
+{
+	const vector3 origin(0);
+	float volume = SignedVolume(aPoints[0], aPoints[1], aPoints[2], aPoints[3]);
+	// Volume of the tetrahedron with each vertex replaced by the origin, they add up to the full volume
+	float volumes[4] = {
+		SignedVolume(origin, aPoints[1], aPoints[2], aPoints[3]),
+		SignedVolume(aPoints[0], origin, aPoints[2], aPoints[3]),
+		SignedVolume(aPoints[0], aPoints[1], origin, aPoints[3]),
+		SignedVolume(aPoints[0], aPoints[1], aPoints[2], origin) };
+
+	if (CompareSigns(volume, volumes[0]) && CompareSigns(volume, volumes[1]) && CompareSigns(volume, volumes[2]) && CompareSigns(volume, volumes[3]))
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			aResultIndices[i] = i;
+			aResultWeights[i] = volumes[i] / volume;
+		}
+		return 4;
+	}
+
+	// The closest point is on one of the faces facing the origin, keep the closest of them
+	int bestSize = 0;
+	float bestDistanceSquared = std::numeric_limits<float>::max();
+	for (int i = 0; i < 4; ++i)
+	{
+		if (CompareSigns(volume, volumes[i]))
+			continue;
+
+		int faceIndices[3];
+		float faceWeights[3];
+		int faceSize = SolveTriangle(aPoints, (i + 1) % 4, (i + 2) % 4, (i + 3) % 4, faceIndices, faceWeights);
+		vector3 closestPoint(0);
+		for (int j = 0; j < faceSize; ++j)
+			closestPoint += faceWeights[j] * aPoints[faceIndices[j]];
+
+		float distanceSquared = glm::dot(closestPoint, closestPoint);
+		if (distanceSquared < bestDistanceSquared)
+		{
+			bestDistanceSquared = distanceSquared;
+			bestSize = faceSize;
+			for (int j = 0; j < faceSize; ++j)
+			{
+				aResultIndices[j] = faceIndices[j];
+				aResultWeights[j] = faceWeights[j];
+			}
+		}
+	}
+	return bestSize;
+}
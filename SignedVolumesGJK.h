@@ -0,0 +1,48 @@
+#pragma once
+#include "PhysicsUtilities.h"
+
+class Collider;
+
+// GJK distance query using the Signed Volumes distance sub-algorithm
+// Montanari, Petrinic, Barbieri - Improving the GJK Algorithm for Faster and More Reliable Distance Queries Between Convex Objects (2017)
+// Instead of Johnson's algorithm, the closest point of each simplex to the origin is found by comparing the signs of the
+// volumes (areas, lengths) of the sub-simplices formed with the projection of the origin. Triangles and segments are
+// projected onto the axis aligned plane/axis where they are largest, which avoids the cancellation errors of Johnson's algorithm.
+// The query returns the distance and the closest points directly, so shallow contacts don't need EPA when the
+// query is run between the core shapes (shapes shrunk by their collision margin).
+class SignedVolumesGJK
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	struct DistanceResult
+	{
+		// Distance between the shapes, zero if they intersect
+		float Distance = 0.0f;
+		// World space closest points
+		vector3 ClosestPointA;
+		vector3 ClosestPointB;
+		// Support function evaluations
+		int IterationCount = 0;
+		// Set when the origin is inside the Minkowski difference, closest points are meaningless then
+		bool bIsIntersecting = false;
+	};
+
+	// Stops once the squared distance is within this fraction of its lower bound
+	float RelativeTolerance = 1e-5f;
+	// Squared distances below this are treated as intersecting
+	float AbsoluteTolerance = 1e-10f;
+	int IterationLimit = 64;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	// Collider model matrices must be up to date, core shapes are used if aUseCoreShapes is set
+	DistanceResult ComputeDistance(Collider * aColliderA, Collider * aColliderB, bool aUseCoreShapes) const;
+
+private:
+	// Sub-algorithms for each simplex size, take the indices of the vertices of the simplex in aPoints
+	// and write the indices and barycentric weights of the smallest sub-simplex containing the closest point, return its size
+	static int SolveSegment(const vector3 * aPoints, int aIndex1, int aIndex2, int * aResultIndices, float * aResultWeights);
+	static int SolveTriangle(const vector3 * aPoints, int aIndex1, int aIndex2, int aIndex3, int * aResultIndices, float * aResultWeights);
+	static int SolveTetrahedron(const vector3 * aPoints, int * aResultIndices, float * aResultWeights);
+
+	static SupportPoint Support(Collider * aColliderA, Collider * aColliderB, const vector3 & aDirection, bool aUseCoreShapes);
+};
@@ -0,0 +1,81 @@
+#include <utility>
+#include "SimulationIslands.h"
+#include "Constraint.h"
+#include "Collider.h"
+
+void SimulationIslands::Build(int aColliderCount, const std::vector<Constraint *> & aConstraints)
+{
+	ParentList.resize(aColliderCount);
+	SizeList.assign(aColliderCount, 1);
+	RootIslandList.assign(aColliderCount, -1);
+	for (int i = 0; i < aColliderCount; ++i)
+		ParentList[i] = i;
+	IslandList.clear();
+
+	// Only constraints between two dynamic bodies link them, a static body never joins two islands
+	for (const Constraint * constraint : aConstraints)
+	{
+		if (constraint->ColliderA->eColliderType != Collider::STATIC && constraint->ColliderB->eColliderType != Collider::STATIC)
+			Merge(constraint->ColliderA->ColliderSlot, constraint->ColliderB->ColliderSlot);
+	}
+
+	// Count the constraints of every island, then place them with a counting sort so each island is a contiguous range
+	std::vector<int> constraintIslandList(aConstraints.size());
+	for (int i = 0; i < (int)aConstraints.size(); ++i)
+	{
+		int root = FindRoot(GetDynamicSlot(aConstraints[i]));
+		if (RootIslandList[root] < 0)
+		{
+			RootIslandList[root] = (int)IslandList.size();
+			IslandList.push_back({ 0, 0 });
+		}
+		constraintIslandList[i] = RootIslandList[root];
+		++IslandList[RootIslandList[root]].ConstraintCount;
+	}
+
+	int firstConstraint = 0;
+	for (Island & island : IslandList)
+	{
+		island.FirstConstraint = firstConstraint;
+		firstConstraint += island.ConstraintCount;
+		island.ConstraintCount = 0;
+	}
+
+	ConstraintList.resize(aConstraints.size());
+	for (int i = 0; i < (int)aConstraints.size(); ++i)
+	{
+		Island & island = IslandList[constraintIslandList[i]];
+		ConstraintList[island.FirstConstraint + island.ConstraintCount++] = aConstraints[i];
+	}
+}
+
+int SimulationIslands::FindRoot(int aSlot)
+{
+	// Path halving, every other node on the way up is pointed at its grandparent
+	while (ParentList[aSlot] != aSlot)
+	{
+		ParentList[aSlot] = ParentList[ParentList[aSlot]];
+		aSlot = ParentList[aSlot];
+	}
+	return aSlot;
+}
+
+void SimulationIslands::Merge(int aSlotA, int aSlotB)
+{
+	int rootA = FindRoot(aSlotA);
+	int rootB = FindRoot(aSlotB);
+	if (rootA == rootB)
+		return;
+
+	// The smaller tree goes under the larger one so the trees stay shallow
+	if (SizeList[rootA] < SizeList[rootB])
+		std::swap(rootA, rootB);
+	ParentList[rootB] = rootA;
+	SizeList[rootA] += SizeList[rootB];
+}
+
+int SimulationIslands::GetDynamicSlot(const Constraint * aConstraint)
+{
+	// Static pairs are never generated, so at least one of the bodies is dynamic
+	return (aConstraint->ColliderA->eColliderType != Collider::STATIC) ? aConstraint->ColliderA->ColliderSlot : aConstraint->ColliderB->ColliderSlot;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+
+class Collider;
+class Constraint;
+
+// Groups the constraints of a step into islands, sets of constraints linked to each other through the dynamic bodies they share
+// Dynamic bodies are merged with union-find (path halving and union by size) over the edges of the constraint graph,
+// static bodies are left out of it so everything resting on the same ground doesn't end up as a single island.
+// Islands share no dynamic bodies, so each one can be solved on its own, in any order and on any thread.
+class SimulationIslands
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	struct Island
+	{
+		// Range of the island in the constraint list
+		int FirstConstraint;
+		int ConstraintCount;
+	};
+private:
+	// Indexed by collider slot, parent in the union-find forest, roots point to themselves
+	std::vector<int> ParentList;
+	// Number of bodies under each root
+	std::vector<int> SizeList;
+	// Island index of each root, -1 until the island is created
+	std::vector<int> RootIslandList;
+	std::vector<Island> IslandList;
+	// Every constraint, grouped by island
+	std::vector<Constraint *> ConstraintList;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	// Rebuilds the islands from scratch, aColliderCount is the size of the collider objects list
+	void Build(int aColliderCount, const std::vector<Constraint *> & aConstraints);
+
+	inline int GetIslandCount() const { return (int)IslandList.size(); }
+	inline const Island & GetIsland(int aIndex) const { return IslandList[aIndex]; }
+	inline Constraint * GetConstraint(int aIndex) const { return ConstraintList[aIndex]; }
+	inline int GetConstraintCount() const { return (int)ConstraintList.size(); }
+	// Representative slot of the island of the body in aSlot, bodies that share no constraint with another are their own root
+	int FindRoot(int aSlot);
+
+private:
+	void Merge(int aSlotA, int aSlotB);
+	// Slot of the dynamic body the island of the constraint is found from
+	static int GetDynamicSlot(const Constraint * aConstraint);
+};
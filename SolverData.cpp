@@ -0,0 +1,603 @@
+#include <algorithm>
+#include <cmath>
+#include "SolverData.h"
+#include "Physics.h"
+
+void SolverBodyList::Clear()
+{
+	LinearVelocityList.assign(1, vector3(0));
+	AngularVelocityList.assign(1, vector3(0));
+	InverseMassList.assign(1, 0.0f);
+	InverseInertiaList.assign(1, matrix3(0.0f));
+	ForceList.assign(1, vector3(0));
+	TorqueList.assign(1, vector3(0));
+	PhysicsList.assign(1, nullptr);
+}
+
+int SolverBodyList::Add(Physics & aPhysics, const matrix3 & aWorldInverseInertia)
+{
+	LinearVelocityList.push_back(aPhysics.CurrentLinearVelocity);
+	AngularVelocityList.push_back(aPhysics.CurrentAngularVelocity);
+	InverseMassList.push_back(aPhysics.InverseMass);
+	InverseInertiaList.push_back(aWorldInverseInertia);
+	ForceList.push_back(aPhysics.Force);
+	TorqueList.push_back(aPhysics.Torque);
+	PhysicsList.push_back(&aPhysics);
+	return (int)PhysicsList.size() - 1;
+}
+
+float SolverBodyList::SolveRow(ConstraintRow & aRow, float aTimestep)
+{
+	int bodyA = aRow.BodyA;
+	int bodyB = aRow.BodyB;
+
+	// J * V, relative velocity of the bodies along the constraint
+	float projection = glm::dot(aRow.LinearJacobianA, LinearVelocityList[bodyA]) + glm::dot(aRow.AngularJacobianA, AngularVelocityList[bodyA]) +
+					   glm::dot(aRow.LinearJacobianB, LinearVelocityList[bodyB]) + glm::dot(aRow.AngularJacobianB, AngularVelocityList[bodyB]);
+	// If relative velocity is separating the objects, constraint is solved
+	if (aRow.LowerLimit >= 0.0f && aRow.UpperLimit > 0.0f && projection > 0.0f)
+		return 0.0f;
+
+	float biasTerm = aRow.Bias + (projection * aRow.Restitution) / aTimestep;
+
+	/* -- Calculating 'Catto_eta' values - Equation 35 in 'Iterative Dynamics' -- */
+	float cattoEta = biasTerm + projection / aTimestep + aRow.ExternalForceTerm;
+
+	/* -- Calculating ∆λi -- */
+	// The velocities are updated after every row, so they already account for the impulses Catto's a vector would hold
+	float deltaLambda = -cattoEta / aRow.EffectiveMass;
+
+	float impulseSumCopy = aRow.ImpulseSum;
+	aRow.ImpulseSum = std::max(aRow.LowerLimit, std::min(aRow.ImpulseSum + deltaLambda, aRow.UpperLimit));
+	deltaLambda = aRow.ImpulseSum - impulseSumCopy;
+	return deltaLambda;
+}
+
+void SolverBodyList::ApplyImpulse(const ConstraintRow & aRow, float aImpulse)
+{
+	// The static body is shared between islands solved on other threads and is never written to
+	if (aRow.BodyA != StaticBody)
+	{
+		LinearVelocityList[aRow.BodyA] += (aImpulse * aRow.InverseMassA) * aRow.LinearJacobianA;
+		AngularVelocityList[aRow.BodyA] += aImpulse * aRow.AngularCatto_BA;
+	}
+	if (aRow.BodyB != StaticBody)
+	{
+		LinearVelocityList[aRow.BodyB] += (aImpulse * aRow.InverseMassB) * aRow.LinearJacobianB;
+		AngularVelocityList[aRow.BodyB] += aImpulse * aRow.AngularCatto_BB;
+	}
+}
+
+SolverResidual SolverBodyList::SolveFrictionRows(ConstraintRow * aFrictionRows, float aNormalImpulse, float aTimestep)
+{
+	SolverResidual residual;
+	if (aFrictionRows[0].FrictionCoefficient == 0.0f)
+		return residual;
+	for (int i = 0; i < ConstraintRow::FrictionRowCount; ++i)
+	{
+		ConstraintRow & row = aFrictionRows[i];
+		row.SetFrictionLimits(aNormalImpulse);
+		float deltaLambda = SolveRow(row, aTimestep);
+		if (abs(deltaLambda) < ConvergedImpulse)
+			deltaLambda = 0.0f;
+		residual.Add(deltaLambda, row.ImpulseSum);
+		if (deltaLambda != 0.0f)
+			ApplyImpulse(row, deltaLambda * aTimestep);
+	}
+	return residual;
+}
+
+void SolverBodyList::WriteBack()
+{
+	for (int i = StaticBody + 1; i < GetCount(); ++i)
+	{
+		PhysicsList[i]->CurrentLinearVelocity = LinearVelocityList[i];
+		PhysicsList[i]->CurrentAngularVelocity = AngularVelocityList[i];
+	}
+}
+
+// Solves aMatrix * x = aVector in place with Gaussian elimination and partial pivoting, aVector becomes x
+// Returns the determinant, 0 if the matrix is singular
+static float SolveLinearSystem(float aMatrix[ContactBlock::MaxRowCount][ContactBlock::MaxRowCount], float aVector[ContactBlock::MaxRowCount], int aSize)
+{
+	float determinant = 1.0f;
+	for (int column = 0; column < aSize; ++column)
+	{
+		int pivot = column;
+		for (int row = column + 1; row < aSize; ++row)
+		{
+			if (abs(aMatrix[row][column]) > abs(aMatrix[pivot][column]))
+				pivot = row;
+		}
+		if (aMatrix[pivot][column] == 0.0f)
+			return 0.0f;
+		if (pivot != column)
+		{
+			for (int i = 0; i < aSize; ++i)
+				std::swap(aMatrix[pivot][i], aMatrix[column][i]);
+			std::swap(aVector[pivot], aVector[column]);
+			determinant = -determinant;
+		}
+		determinant *= aMatrix[column][column];
+		for (int row = column + 1; row < aSize; ++row)
+		{
+			float factor = aMatrix[row][column] / aMatrix[column][column];
+			for (int i = column; i < aSize; ++i)
+				aMatrix[row][i] -= factor * aMatrix[column][i];
+			aVector[row] -= factor * aVector[column];
+		}
+	}
+	for (int row = aSize - 1; row >= 0; --row)
+	{
+		for (int i = row + 1; i < aSize; ++i)
+			aVector[row] -= aMatrix[row][i] * aVector[i];
+		aVector[row] /= aMatrix[row][row];
+	}
+	return determinant;
+}
+
+void ContactBlock::PreStep(const std::vector<ConstraintRow> & aRows, float aMaxConditionNumber)
+{
+	for (int i = 0; i < RowCount; ++i)
+	{
+		const ConstraintRow & rowI = aRows[Rows[i]];
+		for (int j = 0; j < RowCount; ++j)
+		{
+			const ConstraintRow & rowJ = aRows[Rows[j]];
+			K[i][j] = rowI.InverseMassA * glm::dot(rowI.LinearJacobianA, rowJ.LinearJacobianA) + glm::dot(rowI.AngularJacobianA, rowJ.AngularCatto_BA) +
+					  rowI.InverseMassB * glm::dot(rowI.LinearJacobianB, rowJ.LinearJacobianB) + glm::dot(rowI.AngularJacobianB, rowJ.AngularCatto_BB);
+		}
+	}
+
+	// Box2D's test for 2 points is k11^2 < maxCondition * det(K), the largest diagonal raised to the size of the subset in general
+	// The empty subset, no point pushing, needs no solve
+	SolvableSubsetMask = 1;
+	for (int subset = 1; subset < (1 << RowCount); ++subset)
+	{
+		int subsetRows[MaxRowCount];
+		int subsetSize = 0;
+		for (int i = 0; i < RowCount; ++i)
+		{
+			if (subset & (1 << i))
+				subsetRows[subsetSize++] = i;
+		}
+		float matrix[MaxRowCount][MaxRowCount];
+		float vector[MaxRowCount] = {};
+		float maxDiagonal = 0.0f;
+		for (int i = 0; i < subsetSize; ++i)
+		{
+			for (int j = 0; j < subsetSize; ++j)
+				matrix[i][j] = K[subsetRows[i]][subsetRows[j]];
+			maxDiagonal = std::max(maxDiagonal, matrix[i][i]);
+		}
+		float determinant = SolveLinearSystem(matrix, vector, subsetSize);
+		if (determinant > 0.0f && std::pow(maxDiagonal, (float)subsetSize) < aMaxConditionNumber * determinant)
+			SolvableSubsetMask |= 1u << subset;
+	}
+}
+
+SolverResidual SolverBodyList::SolveBlock(const ContactBlock & aBlock, std::vector<ConstraintRow> & aRows, float aTimestep)
+{
+	int count = aBlock.RowCount;
+	// The row solve drives Bias + (1 + Restitution) * J * V / dt + ExternalForceTerm to 0, an impulse λ changes it by (1 + Restitution) * K * λ
+	// With b this velocity error minus the response to the impulses already applied, w = M * x + b with M = (1 + Restitution) * K
+	// which is the row's EffectiveMass on the diagonal
+	// and the accumulated impulses x must satisfy x >= 0, w >= 0 and x * w = 0
+	float oldImpulses[ContactBlock::MaxRowCount];
+	float b[ContactBlock::MaxRowCount];
+	float M[ContactBlock::MaxRowCount][ContactBlock::MaxRowCount];
+	for (int i = 0; i < count; ++i)
+	{
+		const ConstraintRow & row = aRows[aBlock.Rows[i]];
+		float projection = glm::dot(row.LinearJacobianA, LinearVelocityList[row.BodyA]) + glm::dot(row.AngularJacobianA, AngularVelocityList[row.BodyA]) +
+						   glm::dot(row.LinearJacobianB, LinearVelocityList[row.BodyB]) + glm::dot(row.AngularJacobianB, AngularVelocityList[row.BodyB]);
+		b[i] = row.Bias + (projection * row.Restitution) / aTimestep + projection / aTimestep + row.ExternalForceTerm;
+		oldImpulses[i] = row.ImpulseSum;
+		for (int j = 0; j < count; ++j)
+			M[i][j] = (1.0f + row.Restitution) * aBlock.K[i][j];
+	}
+	for (int i = 0; i < count; ++i)
+	{
+		for (int j = 0; j < count; ++j)
+			b[i] -= M[i][j] * oldImpulses[j];
+	}
+
+	// Every point pushing is the most likely case for a resting manifold, then fewer and fewer of them down to none
+	for (int pushingMask = (1 << count) - 1; pushingMask >= 0; --pushingMask)
+	{
+		if ((aBlock.SolvableSubsetMask & (1u << pushingMask)) == 0)
+			continue;
+		int pushing[ContactBlock::MaxRowCount];
+		int pushingCount = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			if (pushingMask & (1 << i))
+				pushing[pushingCount++] = i;
+		}
+
+		// Pushing points have w = 0, solve M * x = -b over them
+		float matrix[ContactBlock::MaxRowCount][ContactBlock::MaxRowCount];
+		float x[ContactBlock::MaxRowCount];
+		for (int i = 0; i < pushingCount; ++i)
+		{
+			for (int j = 0; j < pushingCount; ++j)
+				matrix[i][j] = M[pushing[i]][pushing[j]];
+			x[i] = -b[pushing[i]];
+		}
+		if (pushingCount > 0)
+			SolveLinearSystem(matrix, x, pushingCount);
+		bool bIsValid = true;
+		for (int i = 0; i < pushingCount && bIsValid; ++i)
+			bIsValid = x[i] >= 0.0f;
+
+		// The other points have no impulse and must not be approaching
+		// When the points are dependent, like 4 on a face, w of the ones left out is 0 up to rounding, so it is compared to the size of its terms
+		float impulses[ContactBlock::MaxRowCount] = {};
+		for (int i = 0; i < pushingCount; ++i)
+			impulses[pushing[i]] = x[i];
+		for (int i = 0; i < count && bIsValid; ++i)
+		{
+			if (pushingMask & (1 << i))
+				continue;
+			float w = b[i];
+			float magnitude = abs(b[i]);
+			for (int j = 0; j < pushingCount; ++j)
+			{
+				w += M[i][pushing[j]] * x[j];
+				magnitude += abs(M[i][pushing[j]] * x[j]);
+			}
+			bIsValid = w >= -0.0001f * magnitude;
+		}
+		if (bIsValid == false)
+			continue;
+
+		SolverResidual residual;
+		for (int i = 0; i < count; ++i)
+		{
+			ConstraintRow & row = aRows[aBlock.Rows[i]];
+			float deltaLambda = impulses[i] - oldImpulses[i];
+			row.ImpulseSum = impulses[i];
+			if (abs(deltaLambda) < ConvergedImpulse)
+				deltaLambda = 0.0f;
+			residual.Add(deltaLambda, row.ImpulseSum);
+			if (deltaLambda != 0.0f)
+				ApplyImpulse(row, deltaLambda * aTimestep);
+		}
+		return residual;
+	}
+
+	// Sequential impulses, the rows of a manifold are never discarded
+	SolverResidual residual;
+	for (int i = 0; i < count; ++i)
+	{
+		ConstraintRow & row = aRows[aBlock.Rows[i]];
+		float deltaLambda = SolveRow(row, aTimestep);
+		if (abs(deltaLambda) < ConvergedImpulse)
+			deltaLambda = 0.0f;
+		residual.Add(deltaLambda, row.ImpulseSum);
+		if (deltaLambda != 0.0f)
+			ApplyImpulse(row, deltaLambda * aTimestep);
+	}
+	return residual;
+}
+
+void ConstraintRowBatch::Clear()
+{
+	*this = ConstraintRowBatch();
+	for (int lane = 0; lane < LaneCount; ++lane)
+	{
+		// Zero Jacobians on the static body, a non zero effective mass keeps the unused lanes finite
+		EffectiveMass[lane] = 1.0f;
+		BodyA[lane] = SolverBodyList::StaticBody;
+		BodyB[lane] = SolverBodyList::StaticBody;
+		Row[lane] = -1;
+	}
+	ActiveMask = 0;
+	DiscardableMask = 0;
+}
+
+void ConstraintRowBatch::Set(int aLane, const ConstraintRow & aRow, int aRowIndex, bool bIsDiscardable)
+{
+	LinearJacobianA.Set(aLane, aRow.LinearJacobianA);
+	AngularJacobianA.Set(aLane, aRow.AngularJacobianA);
+	LinearJacobianB.Set(aLane, aRow.LinearJacobianB);
+	AngularJacobianB.Set(aLane, aRow.AngularJacobianB);
+	AngularCatto_BA.Set(aLane, aRow.AngularCatto_BA);
+	AngularCatto_BB.Set(aLane, aRow.AngularCatto_BB);
+	InverseMassA[aLane] = aRow.InverseMassA;
+	InverseMassB[aLane] = aRow.InverseMassB;
+	EffectiveMass[aLane] = aRow.EffectiveMass;
+	ExternalForceTerm[aLane] = aRow.ExternalForceTerm;
+	Bias[aLane] = aRow.Bias;
+	Restitution[aLane] = aRow.Restitution;
+	ImpulseSum[aLane] = aRow.ImpulseSum;
+	LowerLimit[aLane] = aRow.LowerLimit;
+	UpperLimit[aLane] = aRow.UpperLimit;
+	FrictionCoefficient[aLane] = aRow.FrictionCoefficient;
+	BodyA[aLane] = aRow.BodyA;
+	BodyB[aLane] = aRow.BodyB;
+	Row[aLane] = aRowIndex;
+	ActiveMask |= 1 << aLane;
+	if (bIsDiscardable)
+		DiscardableMask |= 1 << aLane;
+}
+
+void ConstraintRowBatch::Get(int aLane, ConstraintRow & aRow) const
+{
+	aRow.BodyA = BodyA[aLane];
+	aRow.BodyB = BodyB[aLane];
+	aRow.LinearJacobianA = LinearJacobianA.Get(aLane);
+	aRow.AngularJacobianA = AngularJacobianA.Get(aLane);
+	aRow.LinearJacobianB = LinearJacobianB.Get(aLane);
+	aRow.AngularJacobianB = AngularJacobianB.Get(aLane);
+	aRow.AngularCatto_BA = AngularCatto_BA.Get(aLane);
+	aRow.AngularCatto_BB = AngularCatto_BB.Get(aLane);
+	aRow.InverseMassA = InverseMassA[aLane];
+	aRow.InverseMassB = InverseMassB[aLane];
+	aRow.EffectiveMass = EffectiveMass[aLane];
+	aRow.ExternalForceTerm = ExternalForceTerm[aLane];
+	aRow.Bias = Bias[aLane];
+	aRow.Restitution = Restitution[aLane];
+	aRow.ImpulseSum = ImpulseSum[aLane];
+	aRow.LowerLimit = LowerLimit[aLane];
+	aRow.UpperLimit = UpperLimit[aLane];
+	aRow.FrictionCoefficient = FrictionCoefficient[aLane];
+}
+
+void ConstraintRowBatch::SetFrictionLimits(const ConstraintRowBatch & aNormalBatch)
+{
+	// Same as ConstraintRow::SetFrictionLimits, unused lanes have no coefficient and stay limited to 0
+	for (int lane = 0; lane < LaneCount; ++lane)
+	{
+		UpperLimit[lane] = FrictionCoefficient[lane] * aNormalBatch.ImpulseSum[lane];
+		LowerLimit[lane] = -UpperLimit[lane];
+	}
+}
+
+SolverResidual SolverBodyList::SolveBatch(ConstraintRowBatch & aBatch, float aTimestep, SIMD::InstructionSet aInstructionSet)
+{
+	// Never wider than what the CPU can run
+	aInstructionSet = std::min(aInstructionSet, SIMD::GetSupportedInstructionSet());
+#if defined(PHYSICS_SIMD_AVX2_RUNTIME)
+	if (aInstructionSet == SIMD::AVX2)
+		return SolveBatchAVX2(aBatch, aTimestep);
+#endif
+#if defined(PHYSICS_SIMD_SSE)
+	if (aInstructionSet >= SIMD::SSE)
+		return SolveBatchSSE(aBatch, aTimestep);
+#endif
+	return SolveBatchScalar(aBatch, aTimestep);
+}
+
+SolverResidual SolverBodyList::SolveBatchScalar(ConstraintRowBatch & aBatch, float aTimestep)
+{
+	SolverResidual residual;
+	ConstraintRow row;
+	for (int lane = 0; lane < ConstraintRowBatch::LaneCount; ++lane)
+	{
+		int laneBit = 1 << lane;
+		if ((aBatch.ActiveMask & laneBit) == 0)
+			continue;
+		aBatch.Get(lane, row);
+		float deltaLambda = SolveRow(row, aTimestep);
+		aBatch.ImpulseSum[lane] = row.ImpulseSum;
+		if (abs(deltaLambda) < ConvergedImpulse)
+		{
+			residual.Add(0.0f, row.ImpulseSum);
+			if (aBatch.DiscardableMask & laneBit)
+				aBatch.ActiveMask &= ~laneBit;
+			continue;
+		}
+		residual.Add(deltaLambda, row.ImpulseSum);
+		ApplyImpulse(row, deltaLambda * aTimestep);
+	}
+	return residual;
+}
+
+// The SIMD kernels do the same operations as SolveRow and ApplyImpulse in the same order, one lane per row
+// Velocities are gathered into batches, updated for every lane and only scattered back for the lanes that applied an impulse,
+// the static body is never written to
+#if defined(PHYSICS_SIMD_SSE)
+SolverResidual SolverBodyList::SolveBatchSSE(ConstraintRowBatch & aBatch, float aTimestep)
+{
+	Vector3Batch linearVelocityA, angularVelocityA, linearVelocityB, angularVelocityB;
+	for (int lane = 0; lane < ConstraintRowBatch::LaneCount; ++lane)
+	{
+		linearVelocityA.Set(lane, LinearVelocityList[aBatch.BodyA[lane]]);
+		angularVelocityA.Set(lane, AngularVelocityList[aBatch.BodyA[lane]]);
+		linearVelocityB.Set(lane, LinearVelocityList[aBatch.BodyB[lane]]);
+		angularVelocityB.Set(lane, AngularVelocityList[aBatch.BodyB[lane]]);
+	}
+
+	auto dot = [](const Vector3Batch & aA, const Vector3Batch & aB, int aLane)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(aA.X + aLane), _mm_load_ps(aB.X + aLane)),
+			_mm_mul_ps(_mm_load_ps(aA.Y + aLane), _mm_load_ps(aB.Y + aLane))), _mm_mul_ps(_mm_load_ps(aA.Z + aLane), _mm_load_ps(aB.Z + aLane)));
+	};
+	// aVelocity += aScale * aDirection
+	auto addScaled = [](Vector3Batch & aVelocity, __m128 aScale, const Vector3Batch & aDirection, int aLane)
+	{
+		_mm_store_ps(aVelocity.X + aLane, _mm_add_ps(_mm_load_ps(aVelocity.X + aLane), _mm_mul_ps(aScale, _mm_load_ps(aDirection.X + aLane))));
+		_mm_store_ps(aVelocity.Y + aLane, _mm_add_ps(_mm_load_ps(aVelocity.Y + aLane), _mm_mul_ps(aScale, _mm_load_ps(aDirection.Y + aLane))));
+		_mm_store_ps(aVelocity.Z + aLane, _mm_add_ps(_mm_load_ps(aVelocity.Z + aLane), _mm_mul_ps(aScale, _mm_load_ps(aDirection.Z + aLane))));
+	};
+
+	__m128 timestep = _mm_set1_ps(aTimestep);
+	__m128 zero = _mm_setzero_ps();
+	__m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 convergedImpulse = _mm_set1_ps(ConvergedImpulse);
+	__m128i laneBits = _mm_setr_epi32(1, 2, 4, 8);
+	__m128 maxDeltaLambda = zero;
+	__m128 maxImpulseSum = zero;
+	int appliedMask = 0;
+	for (int lane = 0; lane < ConstraintRowBatch::LaneCount; lane += 4)
+	{
+		int groupMask = (aBatch.ActiveMask >> lane) & 0xf;
+		if (groupMask == 0)
+			continue;
+		__m128 active = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(groupMask), laneBits), laneBits));
+
+		// J * V
+		__m128 projection = _mm_add_ps(_mm_add_ps(_mm_add_ps(dot(aBatch.LinearJacobianA, linearVelocityA, lane), dot(aBatch.AngularJacobianA, angularVelocityA, lane)),
+			dot(aBatch.LinearJacobianB, linearVelocityB, lane)), dot(aBatch.AngularJacobianB, angularVelocityB, lane));
+		__m128 lowerLimit = _mm_load_ps(aBatch.LowerLimit + lane);
+		__m128 upperLimit = _mm_load_ps(aBatch.UpperLimit + lane);
+		__m128 separating = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(lowerLimit, zero), _mm_cmpgt_ps(upperLimit, zero)), _mm_cmpgt_ps(projection, zero));
+
+		__m128 biasTerm = _mm_add_ps(_mm_load_ps(aBatch.Bias + lane), _mm_div_ps(_mm_mul_ps(projection, _mm_load_ps(aBatch.Restitution + lane)), timestep));
+		__m128 cattoEta = _mm_add_ps(_mm_add_ps(biasTerm, _mm_div_ps(projection, timestep)), _mm_load_ps(aBatch.ExternalForceTerm + lane));
+		__m128 deltaLambda = _mm_div_ps(_mm_xor_ps(cattoEta, _mm_set1_ps(-0.0f)), _mm_load_ps(aBatch.EffectiveMass + lane));
+
+		// Operand order matches std::min and std::max when the values are equal
+		__m128 impulseSum = _mm_load_ps(aBatch.ImpulseSum + lane);
+		__m128 clampedSum = _mm_max_ps(_mm_min_ps(upperLimit, _mm_add_ps(impulseSum, deltaLambda)), lowerLimit);
+		__m128 solved = _mm_andnot_ps(separating, active);
+		deltaLambda = _mm_and_ps(solved, _mm_sub_ps(clampedSum, impulseSum));
+		impulseSum = _mm_or_ps(_mm_and_ps(solved, clampedSum), _mm_andnot_ps(solved, impulseSum));
+		_mm_store_ps(aBatch.ImpulseSum + lane, impulseSum);
+		maxImpulseSum = _mm_max_ps(maxImpulseSum, _mm_and_ps(active, _mm_and_ps(impulseSum, absMask)));
+
+		__m128 absDeltaLambda = _mm_and_ps(deltaLambda, absMask);
+		__m128 converged = _mm_and_ps(active, _mm_cmplt_ps(absDeltaLambda, convergedImpulse));
+		__m128 applied = _mm_andnot_ps(converged, active);
+		aBatch.ActiveMask &= ~((_mm_movemask_ps(converged) << lane) & aBatch.DiscardableMask);
+		appliedMask |= _mm_movemask_ps(applied) << lane;
+		maxDeltaLambda = _mm_max_ps(maxDeltaLambda, _mm_and_ps(applied, absDeltaLambda));
+
+		__m128 impulse = _mm_mul_ps(_mm_and_ps(applied, deltaLambda), timestep);
+		addScaled(linearVelocityA, _mm_mul_ps(impulse, _mm_load_ps(aBatch.InverseMassA + lane)), aBatch.LinearJacobianA, lane);
+		addScaled(angularVelocityA, impulse, aBatch.AngularCatto_BA, lane);
+		addScaled(linearVelocityB, _mm_mul_ps(impulse, _mm_load_ps(aBatch.InverseMassB + lane)), aBatch.LinearJacobianB, lane);
+		addScaled(angularVelocityB, impulse, aBatch.AngularCatto_BB, lane);
+	}
+
+	for (int lane = 0; lane < ConstraintRowBatch::LaneCount; ++lane)
+	{
+		if ((appliedMask & (1 << lane)) == 0)
+			continue;
+		if (aBatch.BodyA[lane] != StaticBody)
+		{
+			LinearVelocityList[aBatch.BodyA[lane]] = linearVelocityA.Get(lane);
+			AngularVelocityList[aBatch.BodyA[lane]] = angularVelocityA.Get(lane);
+		}
+		if (aBatch.BodyB[lane] != StaticBody)
+		{
+			LinearVelocityList[aBatch.BodyB[lane]] = linearVelocityB.Get(lane);
+			AngularVelocityList[aBatch.BodyB[lane]] = angularVelocityB.Get(lane);
+		}
+	}
+
+	alignas(16) float laneMax[4];
+	alignas(16) float laneMaxImpulse[4];
+	_mm_store_ps(laneMax, maxDeltaLambda);
+	_mm_store_ps(laneMaxImpulse, maxImpulseSum);
+	SolverResidual residual;
+	for (int lane = 0; lane < 4; ++lane)
+		residual.Add(laneMax[lane], laneMaxImpulse[lane]);
+	return residual;
+}
+#endif
+
+#if defined(PHYSICS_SIMD_AVX2_RUNTIME)
+// Dot product of the 8 vectors of aA with the gathered ones, summed in the same order as glm::dot
+static PHYSICS_SIMD_TARGET_AVX2 inline __m256 Dot(const Vector3Batch & aA, __m256 aX, __m256 aY, __m256 aZ)
+{
+	return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(aA.X), aX), _mm256_mul_ps(_mm256_load_ps(aA.Y), aY)), _mm256_mul_ps(_mm256_load_ps(aA.Z), aZ));
+}
+
+PHYSICS_SIMD_TARGET_AVX2 SolverResidual SolverBodyList::SolveBatchAVX2(ConstraintRowBatch & aBatch, float aTimestep)
+{
+	// The velocities are packed vector3s, component k of body i is float 3 * i + k
+	const float * linearVelocities = &LinearVelocityList[0].x;
+	const float * angularVelocities = &AngularVelocityList[0].x;
+	__m256i bodyA = _mm256_mullo_epi32(_mm256_load_si256((const __m256i *)aBatch.BodyA), _mm256_set1_epi32(3));
+	__m256i bodyB = _mm256_mullo_epi32(_mm256_load_si256((const __m256i *)aBatch.BodyB), _mm256_set1_epi32(3));
+	__m256i one = _mm256_set1_epi32(1);
+	__m256i two = _mm256_set1_epi32(2);
+	__m256 vAX = _mm256_i32gather_ps(linearVelocities, bodyA, 4);
+	__m256 vAY = _mm256_i32gather_ps(linearVelocities, _mm256_add_epi32(bodyA, one), 4);
+	__m256 vAZ = _mm256_i32gather_ps(linearVelocities, _mm256_add_epi32(bodyA, two), 4);
+	__m256 wAX = _mm256_i32gather_ps(angularVelocities, bodyA, 4);
+	__m256 wAY = _mm256_i32gather_ps(angularVelocities, _mm256_add_epi32(bodyA, one), 4);
+	__m256 wAZ = _mm256_i32gather_ps(angularVelocities, _mm256_add_epi32(bodyA, two), 4);
+	__m256 vBX = _mm256_i32gather_ps(linearVelocities, bodyB, 4);
+	__m256 vBY = _mm256_i32gather_ps(linearVelocities, _mm256_add_epi32(bodyB, one), 4);
+	__m256 vBZ = _mm256_i32gather_ps(linearVelocities, _mm256_add_epi32(bodyB, two), 4);
+	__m256 wBX = _mm256_i32gather_ps(angularVelocities, bodyB, 4);
+	__m256 wBY = _mm256_i32gather_ps(angularVelocities, _mm256_add_epi32(bodyB, one), 4);
+	__m256 wBZ = _mm256_i32gather_ps(angularVelocities, _mm256_add_epi32(bodyB, two), 4);
+
+	__m256 timestep = _mm256_set1_ps(aTimestep);
+	__m256 zero = _mm256_setzero_ps();
+	__m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	__m256 active = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(aBatch.ActiveMask), laneBits), laneBits));
+
+	// J * V
+	__m256 projection = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(Dot(aBatch.LinearJacobianA, vAX, vAY, vAZ), Dot(aBatch.AngularJacobianA, wAX, wAY, wAZ)),
+		Dot(aBatch.LinearJacobianB, vBX, vBY, vBZ)), Dot(aBatch.AngularJacobianB, wBX, wBY, wBZ));
+	__m256 lowerLimit = _mm256_load_ps(aBatch.LowerLimit);
+	__m256 upperLimit = _mm256_load_ps(aBatch.UpperLimit);
+	__m256 separating = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(lowerLimit, zero, _CMP_GE_OQ), _mm256_cmp_ps(upperLimit, zero, _CMP_GT_OQ)), _mm256_cmp_ps(projection, zero, _CMP_GT_OQ));
+
+	__m256 biasTerm = _mm256_add_ps(_mm256_load_ps(aBatch.Bias), _mm256_div_ps(_mm256_mul_ps(projection, _mm256_load_ps(aBatch.Restitution)), timestep));
+	__m256 cattoEta = _mm256_add_ps(_mm256_add_ps(biasTerm, _mm256_div_ps(projection, timestep)), _mm256_load_ps(aBatch.ExternalForceTerm));
+	__m256 deltaLambda = _mm256_div_ps(_mm256_xor_ps(cattoEta, _mm256_set1_ps(-0.0f)), _mm256_load_ps(aBatch.EffectiveMass));
+
+	// Operand order matches std::min and std::max when the values are equal
+	__m256 impulseSum = _mm256_load_ps(aBatch.ImpulseSum);
+	__m256 clampedSum = _mm256_max_ps(_mm256_min_ps(upperLimit, _mm256_add_ps(impulseSum, deltaLambda)), lowerLimit);
+	__m256 solved = _mm256_andnot_ps(separating, active);
+	deltaLambda = _mm256_and_ps(solved, _mm256_sub_ps(clampedSum, impulseSum));
+	impulseSum = _mm256_blendv_ps(impulseSum, clampedSum, solved);
+	_mm256_store_ps(aBatch.ImpulseSum, impulseSum);
+
+	__m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	__m256 absDeltaLambda = _mm256_and_ps(deltaLambda, absMask);
+	__m256 converged = _mm256_and_ps(active, _mm256_cmp_ps(absDeltaLambda, _mm256_set1_ps(ConvergedImpulse), _CMP_LT_OQ));
+	__m256 applied = _mm256_andnot_ps(converged, active);
+	aBatch.ActiveMask &= ~(_mm256_movemask_ps(converged) & aBatch.DiscardableMask);
+	int appliedMask = _mm256_movemask_ps(applied);
+
+	__m256 impulse = _mm256_mul_ps(_mm256_and_ps(applied, deltaLambda), timestep);
+	__m256 scaleA = _mm256_mul_ps(impulse, _mm256_load_ps(aBatch.InverseMassA));
+	__m256 scaleB = _mm256_mul_ps(impulse, _mm256_load_ps(aBatch.InverseMassB));
+	Vector3Batch linearVelocityA, angularVelocityA, linearVelocityB, angularVelocityB;
+	_mm256_store_ps(linearVelocityA.X, _mm256_add_ps(vAX, _mm256_mul_ps(scaleA, _mm256_load_ps(aBatch.LinearJacobianA.X))));
+	_mm256_store_ps(linearVelocityA.Y, _mm256_add_ps(vAY, _mm256_mul_ps(scaleA, _mm256_load_ps(aBatch.LinearJacobianA.Y))));
+	_mm256_store_ps(linearVelocityA.Z, _mm256_add_ps(vAZ, _mm256_mul_ps(scaleA, _mm256_load_ps(aBatch.LinearJacobianA.Z))));
+	_mm256_store_ps(angularVelocityA.X, _mm256_add_ps(wAX, _mm256_mul_ps(impulse, _mm256_load_ps(aBatch.AngularCatto_BA.X))));
+	_mm256_store_ps(angularVelocityA.Y, _mm256_add_ps(wAY, _mm256_mul_ps(impulse, _mm256_load_ps(aBatch.AngularCatto_BA.Y))));
+	_mm256_store_ps(angularVelocityA.Z, _mm256_add_ps(wAZ, _mm256_mul_ps(impulse, _mm256_load_ps(aBatch.AngularCatto_BA.Z))));
+	_mm256_store_ps(linearVelocityB.X, _mm256_add_ps(vBX, _mm256_mul_ps(scaleB, _mm256_load_ps(aBatch.LinearJacobianB.X))));
+	_mm256_store_ps(linearVelocityB.Y, _mm256_add_ps(vBY, _mm256_mul_ps(scaleB, _mm256_load_ps(aBatch.LinearJacobianB.Y))));
+	_mm256_store_ps(linearVelocityB.Z, _mm256_add_ps(vBZ, _mm256_mul_ps(scaleB, _mm256_load_ps(aBatch.LinearJacobianB.Z))));
+	_mm256_store_ps(angularVelocityB.X, _mm256_add_ps(wBX, _mm256_mul_ps(impulse, _mm256_load_ps(aBatch.AngularCatto_BB.X))));
+	_mm256_store_ps(angularVelocityB.Y, _mm256_add_ps(wBY, _mm256_mul_ps(impulse, _mm256_load_ps(aBatch.AngularCatto_BB.Y))));
+	_mm256_store_ps(angularVelocityB.Z, _mm256_add_ps(wBZ, _mm256_mul_ps(impulse, _mm256_load_ps(aBatch.AngularCatto_BB.Z))));
+
+	for (int lane = 0; lane < ConstraintRowBatch::LaneCount; ++lane)
+	{
+		if ((appliedMask & (1 << lane)) == 0)
+			continue;
+		if (aBatch.BodyA[lane] != StaticBody)
+		{
+			LinearVelocityList[aBatch.BodyA[lane]] = linearVelocityA.Get(lane);
+			AngularVelocityList[aBatch.BodyA[lane]] = angularVelocityA.Get(lane);
+		}
+		if (aBatch.BodyB[lane] != StaticBody)
+		{
+			LinearVelocityList[aBatch.BodyB[lane]] = linearVelocityB.Get(lane);
+			AngularVelocityList[aBatch.BodyB[lane]] = angularVelocityB.Get(lane);
+		}
+	}
+
+	alignas(32) float laneMax[ConstraintRowBatch::LaneCount];
+	alignas(32) float laneMaxImpulse[ConstraintRowBatch::LaneCount];
+	_mm256_store_ps(laneMax, _mm256_and_ps(applied, absDeltaLambda));
+	_mm256_store_ps(laneMaxImpulse, _mm256_and_ps(active, _mm256_and_ps(impulseSum, absMask)));
+	SolverResidual residual;
+	for (int lane = 0; lane < ConstraintRowBatch::LaneCount; ++lane)
+		residual.Add(laneMax[lane], laneMaxImpulse[lane]);
+	return residual;
+}
+#endif
@@ -0,0 +1,182 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Typedefs.h"
+#include "SIMDUtilities.h"
+
+class Physics;
+
+// One scalar constraint equation between two solver bodies, filled by the prestep of its constraint
+// Rows are stored contiguously in island order so the solver iterations walk through memory instead of chasing constraints
+struct ConstraintRow
+{
+	// Contact rows have one friction row per tangent, kept beside the constraint rows in the same order
+	static const int FrictionRowCount = 2;
+	// Indices in the solver body list, static bodies all use SolverBodyList::StaticBody
+	int BodyA;
+	int BodyB;
+	// The 1x12 Jacobian split into the linear and angular part of each body
+	vector3 LinearJacobianA;
+	vector3 AngularJacobianA;
+	vector3 LinearJacobianB;
+	vector3 AngularJacobianB;
+	// Angular part of B = M^-1 * J^T, the linear part is the linear Jacobian scaled by the inverse mass of the body
+	vector3 AngularCatto_BA;
+	vector3 AngularCatto_BB;
+	float InverseMassA;
+	float InverseMassB;
+	// (1 + Restitution) * J * M^-1 * J^T, the restitution term responds to an impulse like the velocity term does
+	float EffectiveMass;
+	// J * M^-1 * Fext, the external forces don't change while the constraints are solved
+	float ExternalForceTerm;
+	// Velocity bias from the position error (Baumgarte stabilization)
+	float Bias;
+	// Fraction of the approach velocity added to the bias
+	float Restitution;
+	// Accumulated impulse, clamped to [LowerLimit, UpperLimit], a row with a lower limit of 0 can only push and does nothing while the bodies separate
+	// A row limited to [0, 0], like friction without a normal impulse, is still solved so its impulse gets clamped back to 0
+	float ImpulseSum;
+	float LowerLimit;
+	float UpperLimit;
+	// Friction rows are limited to ± this times the impulse of their normal rows, 0 for every other row
+	float FrictionCoefficient;
+
+	inline void SetFrictionLimits(float aNormalImpulse)
+	{
+		UpperLimit = FrictionCoefficient * aNormalImpulse;
+		LowerLimit = -UpperLimit;
+	}
+};
+
+// How much one solver iteration changed the rows it went through, the island solvers stop once it is small enough
+struct SolverResidual
+{
+	// Largest absolute change of an accumulated impulse
+	float MaxDeltaLambda = 0.0f;
+	// Largest absolute accumulated impulse after the change, what the change is relative to
+	float MaxImpulseSum = 0.0f;
+
+	inline void Add(float aDeltaLambda, float aImpulseSum)
+	{
+		MaxDeltaLambda = std::max(MaxDeltaLambda, std::abs(aDeltaLambda));
+		MaxImpulseSum = std::max(MaxImpulseSum, std::abs(aImpulseSum));
+	}
+	inline void Add(const SolverResidual & aResidual)
+	{
+		MaxDeltaLambda = std::max(MaxDeltaLambda, aResidual.MaxDeltaLambda);
+		MaxImpulseSum = std::max(MaxImpulseSum, aResidual.MaxImpulseSum);
+	}
+	// 0 when no row holds an impulse
+	inline float GetRelative() const { return MaxImpulseSum > 0.0f ? MaxDeltaLambda / MaxImpulseSum : 0.0f; }
+};
+
+// Normal rows of the points of one contact manifold, all between the same two bodies
+// Solved together as a small LCP, each point's impulse then accounts for the others instead of fighting them over the iterations
+struct ContactBlock
+{
+	static const int MaxRowCount = 4;
+	int RowCount;
+	// Indices in the row list
+	int Rows[MaxRowCount];
+	// J * M^-1 * J^T of every pair of rows, the diagonal is the effective mass of each row
+	float K[MaxRowCount][MaxRowCount];
+	// Bit per subset of the rows (bit 0b0101 for rows 0 and 2), set if the part of K over those rows is well conditioned enough to solve directly
+	// 4 points of a face all share the normal and only constrain 3 degrees of freedom, so their full K is singular but its subsets of 3 aren't
+	unsigned int SolvableSubsetMask;
+
+	// Fills K from the prestepped rows, the condition number of each subset is estimated from its diagonal and determinant
+	void PreStep(const std::vector<ConstraintRow> & aRows, float aMaxConditionNumber);
+};
+
+// Up to 8 rows of one graph color side by side (AoSoA), lane i of every array belongs to the same row
+// Rows of a color don't share a dynamic body, so a whole batch can be solved at once without the lanes seeing each other's impulses
+struct alignas(32) ConstraintRowBatch
+{
+	static const int LaneCount = Vector3Batch::Size;
+	Vector3Batch LinearJacobianA;
+	Vector3Batch AngularJacobianA;
+	Vector3Batch LinearJacobianB;
+	Vector3Batch AngularJacobianB;
+	Vector3Batch AngularCatto_BA;
+	Vector3Batch AngularCatto_BB;
+	alignas(32) float InverseMassA[LaneCount];
+	alignas(32) float InverseMassB[LaneCount];
+	alignas(32) float EffectiveMass[LaneCount];
+	alignas(32) float ExternalForceTerm[LaneCount];
+	alignas(32) float Bias[LaneCount];
+	alignas(32) float Restitution[LaneCount];
+	alignas(32) float ImpulseSum[LaneCount];
+	alignas(32) float LowerLimit[LaneCount];
+	alignas(32) float UpperLimit[LaneCount];
+	alignas(32) float FrictionCoefficient[LaneCount];
+	alignas(32) int BodyA[LaneCount];
+	alignas(32) int BodyB[LaneCount];
+	// Index in the row list of each lane, -1 for the unused lanes of the last batch of a color
+	int Row[LaneCount];
+	// Bit per lane, lanes still being solved and lanes whose constraint may be discarded once it converges
+	int ActiveMask;
+	int DiscardableMask;
+
+	// Every lane becomes an unused one that solves to a zero impulse on the static body
+	void Clear();
+	void Set(int aLane, const ConstraintRow & aRow, int aRowIndex, bool bIsDiscardable);
+	// Copies the lane back into the row, only the impulse sum changes while solving
+	void Get(int aLane, ConstraintRow & aRow) const;
+	// For a batch of friction rows, limits each lane by the impulse of the same lane of the batch of their normal rows
+	void SetFrictionLimits(const ConstraintRowBatch & aNormalBatch);
+};
+
+// Velocities and mass properties of the awake bodies being solved, as separate arrays (SoA) indexed by solver body
+// Entry 0 is shared by every static body, it never moves and has no inverse mass, so rows don't need to special case it
+class SolverBodyList
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	static const int StaticBody = 0;
+	// A row whose impulse changes by less than this is converged
+	static constexpr float ConvergedImpulse = 0.0000000001f;
+
+	std::vector<vector3> LinearVelocityList;
+	std::vector<vector3> AngularVelocityList;
+	std::vector<float> InverseMassList;
+	// World space, I^-1 of the unit mass tensor like the one applied to constraint torques
+	std::vector<matrix3> InverseInertiaList;
+	// Only read by the prestep
+	std::vector<vector3> ForceList;
+	std::vector<vector3> TorqueList;
+	// Owner of each body, the velocities are written back to it once the solve is done
+	std::vector<Physics *> PhysicsList;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	// Removes every body but the static one
+	void Clear();
+	// Copies the state of the body, aWorldInverseInertia is I^-1 in world space, returns its index
+	int Add(Physics & aPhysics, const matrix3 & aWorldInverseInertia);
+	inline int GetCount() const { return (int)PhysicsList.size(); }
+
+	// Changes the accumulated impulse of the row by solving it against the current velocities, returns the change
+	// The velocities already hold every impulse applied so far, warm start included
+	float SolveRow(ConstraintRow & aRow, float aTimestep);
+	// Adds the velocity change from an impulse along the row, B * aImpulse
+	void ApplyImpulse(const ConstraintRow & aRow, float aImpulse);
+	// Solves the friction rows of a contact limited by aNormalImpulse, nothing if the first row has no friction coefficient
+	SolverResidual SolveFrictionRows(ConstraintRow * aFrictionRows, float aNormalImpulse, float aTimestep);
+	// Finds the impulses of every row of the block at once by trying each set of points that push until one satisfies the contact conditions,
+	// like Box2D's block solver extended to 4 points. Sets whose part of K is ill-conditioned are skipped, if no set fits each row is solved with SolveRow.
+	SolverResidual SolveBlock(const ContactBlock & aBlock, std::vector<ConstraintRow> & aRows, float aTimestep);
+	// SolveRow and ApplyImpulse for every active lane of the batch, the lanes must not share a dynamic body
+	// Lanes whose impulse stops changing and are discardable become inactive, the residual covers the lanes active before the solve
+	// Every instruction set gives the same result as the scalar reference, bit for bit
+	SolverResidual SolveBatch(ConstraintRowBatch & aBatch, float aTimestep, SIMD::InstructionSet aInstructionSet);
+	// Copies the solved velocities back to the physics components
+	void WriteBack();
+private:
+	SolverResidual SolveBatchScalar(ConstraintRowBatch & aBatch, float aTimestep);
+#if defined(PHYSICS_SIMD_SSE)
+	SolverResidual SolveBatchSSE(ConstraintRowBatch & aBatch, float aTimestep);
+#endif
+#if defined(PHYSICS_SIMD_AVX2_RUNTIME)
+	PHYSICS_SIMD_TARGET_AVX2 SolverResidual SolveBatchAVX2(ConstraintRowBatch & aBatch, float aTimestep);
+#endif
+};
@@ -0,0 +1,61 @@
+#include "SolverThreadPool.h"
+
+SolverThreadPool::~SolverThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		bIsShuttingDown = true;
+	}
+	JobCondition.notify_all();
+	for (std::thread & worker : WorkerList)
+		worker.join();
+}
+
+void SolverThreadPool::Dispatch(int aThreadCount, void (*aInvokeJob)(void *, int), void * aJob)
+{
+	// The pool only ever grows, workers beyond what a job needs stay parked
+	while ((int)WorkerList.size() < aThreadCount - 1)
+		WorkerList.emplace_back(&SolverThreadPool::WorkerLoop, this, (int)WorkerList.size() + 1);
+
+	{
+		std::lock_guard<std::mutex> lock(Mutex);
+		pInvokeJob = aInvokeJob;
+		pJob = aJob;
+		JobThreadCount = aThreadCount;
+		BusyWorkerCount = aThreadCount - 1;
+		++JobGeneration;
+	}
+	JobCondition.notify_all();
+
+	// The calling thread is the first worker
+	aInvokeJob(aJob, 0);
+
+	std::unique_lock<std::mutex> lock(Mutex);
+	DoneCondition.wait(lock, [this]() { return BusyWorkerCount == 0; });
+	pInvokeJob = nullptr;
+	pJob = nullptr;
+}
+
+void SolverThreadPool::WorkerLoop(int aThread)
+{
+	unsigned int generation = 0;
+	std::unique_lock<std::mutex> lock(Mutex);
+	while (true)
+	{
+		JobCondition.wait(lock, [this, generation]() { return bIsShuttingDown || JobGeneration != generation; });
+		if (bIsShuttingDown)
+			return;
+		generation = JobGeneration;
+		// Jobs on fewer threads leave the workers with higher indices parked
+		if (aThread >= JobThreadCount)
+			continue;
+
+		void (*invokeJob)(void *, int) = pInvokeJob;
+		void * job = pJob;
+		lock.unlock();
+		invokeJob(job, aThread);
+		lock.lock();
+		if (--BusyWorkerCount == 0)
+			DoneCondition.notify_one();
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Worker threads that are started the first time they are needed and then parked until the next job, so the solver doesn't
+// create and join threads every step
+// Run hands the same job to the calling thread, as thread 0, and to as many workers as needed, then waits for all of them
+class SolverThreadPool
+{
+	/*-----------MEMBER VARIABLES-----------*/
+private:
+	std::vector<std::thread> WorkerList;
+	std::mutex Mutex;
+	// Workers wait on this one for a new job, the calling thread on the other one for the workers to be done
+	std::condition_variable JobCondition;
+	std::condition_variable DoneCondition;
+	// Type erased job, only valid while Run is waiting for it
+	void (*pInvokeJob)(void *, int) = nullptr;
+	void * pJob = nullptr;
+	int JobThreadCount = 0;
+	// Incremented for every job, so a worker never runs the same job twice
+	unsigned int JobGeneration = 0;
+	// Workers still running the current job
+	int BusyWorkerCount = 0;
+	bool bIsShuttingDown = false;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	SolverThreadPool() {}
+	SolverThreadPool(const SolverThreadPool &) = delete;
+	SolverThreadPool & operator=(const SolverThreadPool &) = delete;
+	~SolverThreadPool();
+
+	// Calls aJob(thread) for every thread in [0, aThreadCount) and returns once all of them are done
+	// A single thread job runs directly on the calling thread, so jobs already running on a worker can use it too
+	template <typename Job>
+	void Run(int aThreadCount, Job & aJob)
+	{
+		if (aThreadCount <= 1)
+		{
+			aJob(0);
+			return;
+		}
+		Dispatch(aThreadCount, [](void * aJob, int aThread) { (*static_cast<Job *>(aJob))(aThread); }, &aJob);
+	}
+
+	inline int GetWorkerCount() const { return (int)WorkerList.size(); }
+
+private:
+	void Dispatch(int aThreadCount, void (*aInvokeJob)(void *, int), void * aJob);
+	void WorkerLoop(int aThread);
+};
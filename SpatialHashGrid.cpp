@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <thread>
+#include "SpatialHashGrid.h"
+#include "Collider.h"
+
+void SpatialHashGrid::AddCollider(Collider * aCollider)
+{
+	int proxyID = aCollider->ColliderSlot;
+	if (proxyID >= (int)ProxyList.size())
+		ProxyList.resize(proxyID + 1, nullptr);
+	ProxyList[proxyID] = aCollider;
+}
+
+void SpatialHashGrid::RemoveCollider(Collider * aCollider)
+{
+	int proxyID = aCollider->ColliderSlot;
+	if (proxyID < (int)ProxyList.size())
+		ProxyList[proxyID] = nullptr;
+}
+
+template <typename T>
+void SpatialHashGrid::ParallelFor(int aCount, T aFunction)
+{
+	int threadCount = 1;
+	if (bIsMultithreaded)
+	{
+		int hardwareThreadCount = std::max(1, (int)std::thread::hardware_concurrency());
+		threadCount = std::max(1, std::min(hardwareThreadCount, aCount / std::max(1, MinProxiesPerThread)));
+	}
+	if ((int)ThreadDataList.size() < threadCount)
+		ThreadDataList.resize(threadCount);
+
+	if (threadCount == 1)
+	{
+		aFunction(ThreadDataList[0], 0, aCount);
+		return;
+	}
+
+	// The calling thread takes the last range
+	std::vector<std::thread> threadList;
+	threadList.reserve(threadCount - 1);
+	int rangeSize = (aCount + threadCount - 1) / threadCount;
+	for (int i = 0; i < threadCount; ++i)
+	{
+		int begin = std::min(i * rangeSize, aCount);
+		int end = std::min(begin + rangeSize, aCount);
+		if (i == threadCount - 1)
+			aFunction(ThreadDataList[i], begin, end);
+		else
+			threadList.emplace_back([&aFunction, this, i, begin, end]() { aFunction(ThreadDataList[i], begin, end); });
+	}
+	for (std::thread & thread : threadList)
+		thread.join();
+}
+
+void SpatialHashGrid::Update()
+{
+	PairList.clear();
+	OversizedProxyList.clear();
+	for (ThreadData & threadData : ThreadDataList)
+	{
+		threadData.EntryList.clear();
+		threadData.OversizedProxyList.clear();
+		threadData.PairList.clear();
+	}
+
+	int proxyCount = (int)ProxyList.size();
+	ProxyBounds.resize(proxyCount);
+	OversizedFlags.assign(proxyCount, 0);
+
+	// Find the cells touched by every proxy
+	ParallelFor(proxyCount, [this](ThreadData & aThreadData, int aBegin, int aEnd) { HashProxies(aThreadData, aBegin, aEnd); });
+
+	int entryCount = 0;
+	for (ThreadData & threadData : ThreadDataList)
+	{
+		entryCount += (int)threadData.EntryList.size();
+		OversizedProxyList.insert(OversizedProxyList.end(), threadData.OversizedProxyList.begin(), threadData.OversizedProxyList.end());
+	}
+
+	// Keep the load factor at or below one half so probe sequences stay short
+	size_t tableSize = 16;
+	while (tableSize < 2 * (size_t)entryCount)
+		tableSize *= 2;
+	if (HashTable.size() != tableSize)
+	{
+		HashTable.assign(tableSize, Cell());
+		for (Cell & cell : HashTable)
+			cell.Key = EmptyKey;
+	}
+	else
+	{
+		// Only the cells used last step need to be emptied
+		for (int cellIndex : OccupiedCellList)
+			HashTable[cellIndex].Key = EmptyKey;
+	}
+	OccupiedCellList.clear();
+
+	// Counting sort of the entries by cell, first count the entries of each cell
+	for (ThreadData & threadData : ThreadDataList)
+	{
+		for (CellEntry & entry : threadData.EntryList)
+		{
+			entry.CellIndex = FindOrAddCell(entry.CellKey, entry.X, entry.Y, entry.Z);
+			++HashTable[entry.CellIndex].Count;
+		}
+	}
+	int start = 0;
+	for (int cellIndex : OccupiedCellList)
+	{
+		HashTable[cellIndex].Start = start;
+		start += HashTable[cellIndex].Count;
+		HashTable[cellIndex].Count = 0;
+	}
+	// Then place each proxy in the range of its cell
+	CellContents.resize(entryCount);
+	for (ThreadData & threadData : ThreadDataList)
+	{
+		for (CellEntry & entry : threadData.EntryList)
+		{
+			Cell & cell = HashTable[entry.CellIndex];
+			CellContents[cell.Start + cell.Count++] = entry.ProxyID;
+		}
+	}
+
+	// Every cell is independent, split them between threads
+	ParallelFor((int)OccupiedCellList.size(), [this](ThreadData & aThreadData, int aBegin, int aEnd) { FindPairsInCells(aThreadData, aBegin, aEnd); });
+
+	for (ThreadData & threadData : ThreadDataList)
+		PairList.insert(PairList.end(), threadData.PairList.begin(), threadData.PairList.end());
+
+	// Oversized proxies are tested against every other proxy, pairs of two oversized proxies only once
+	for (int oversizedProxyID : OversizedProxyList)
+	{
+		for (int proxyID = 0; proxyID < proxyCount; ++proxyID)
+		{
+			if (ProxyList[proxyID] == nullptr || proxyID == oversizedProxyID || (OversizedFlags[proxyID] && proxyID < oversizedProxyID))
+				continue;
+			if (ProxyBounds[oversizedProxyID].Overlaps(ProxyBounds[proxyID]) == false)
+				continue;
+
+			if (proxyID < oversizedProxyID)
+				PairList.emplace_back(ProxyList[proxyID], ProxyList[oversizedProxyID]);
+			else
+				PairList.emplace_back(ProxyList[oversizedProxyID], ProxyList[proxyID]);
+		}
+	}
+}
+
+void SpatialHashGrid::FindOverlappingPairs(std::vector<ColliderPair>& aPairList)
+{
+	aPairList.insert(aPairList.end(), PairList.begin(), PairList.end());
+}
+
+void SpatialHashGrid::HashProxies(ThreadData & aThreadData, int aBegin, int aEnd)
+{
+	for (int proxyID = aBegin; proxyID < aEnd; ++proxyID)
+	{
+		if (ProxyList[proxyID] == nullptr)
+			continue;
+
+		const AABB & bounds = ProxyList[proxyID]->BoundingBox;
+		ProxyBounds[proxyID] = bounds;
+
+		int minX = GetCellCoordinate(bounds.Min.x), minY = GetCellCoordinate(bounds.Min.y), minZ = GetCellCoordinate(bounds.Min.z);
+		int maxX = GetCellCoordinate(bounds.Max.x), maxY = GetCellCoordinate(bounds.Max.y), maxZ = GetCellCoordinate(bounds.Max.z);
+
+		long long cellCount = (long long)(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1);
+		if (cellCount > MaxCellsPerProxy)
+		{
+			OversizedFlags[proxyID] = 1;
+			aThreadData.OversizedProxyList.push_back(proxyID);
+			continue;
+		}
+
+		for (int x = minX; x <= maxX; ++x)
+			for (int y = minY; y <= maxY; ++y)
+				for (int z = minZ; z <= maxZ; ++z)
+					aThreadData.EntryList.push_back({ GetCellKey(x, y, z), x, y, z, proxyID, 0 });
+	}
+}
+
+void SpatialHashGrid::FindPairsInCells(ThreadData & aThreadData, int aBegin, int aEnd)
+{
+	for (int i = aBegin; i < aEnd; ++i)
+	{
+		const Cell & cell = HashTable[OccupiedCellList[i]];
+		for (int a = cell.Start; a < cell.Start + cell.Count; ++a)
+		{
+			int proxyA = CellContents[a];
+			const AABB & boundsA = ProxyBounds[proxyA];
+			for (int b = a + 1; b < cell.Start + cell.Count; ++b)
+			{
+				int proxyB = CellContents[b];
+				const AABB & boundsB = ProxyBounds[proxyB];
+				if (boundsA.Overlaps(boundsB) == false)
+					continue;
+
+				// The overlap starts in exactly one of the cells both proxies share, only that cell reports the pair
+				if (GetCellCoordinate(std::max(boundsA.Min.x, boundsB.Min.x)) != cell.X ||
+					GetCellCoordinate(std::max(boundsA.Min.y, boundsB.Min.y)) != cell.Y ||
+					GetCellCoordinate(std::max(boundsA.Min.z, boundsB.Min.z)) != cell.Z)
+					continue;
+
+				if (proxyA < proxyB)
+					aThreadData.PairList.emplace_back(ProxyList[proxyA], ProxyList[proxyB]);
+				else
+					aThreadData.PairList.emplace_back(ProxyList[proxyB], ProxyList[proxyA]);
+			}
+		}
+	}
+}
+
+int SpatialHashGrid::FindOrAddCell(unsigned long long aKey, int aX, int aY, int aZ)
+{
+	size_t mask = HashTable.size() - 1;
+	size_t index = HashCellKey(aKey) & mask;
+	// Linear probing, the table is never full so an empty cell is always found
+	while (HashTable[index].Key != aKey)
+	{
+		if (HashTable[index].Key == EmptyKey)
+		{
+			Cell & newCell = HashTable[index];
+			newCell.Key = aKey;
+			newCell.X = aX;
+			newCell.Y = aY;
+			newCell.Z = aZ;
+			newCell.Start = 0;
+			newCell.Count = 0;
+			OccupiedCellList.push_back((int)index);
+			break;
+		}
+		index = (index + 1) & mask;
+	}
+	return (int)index;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include "Broadphase.h"
+
+// Broadphase that hashes every collider into the cells of an infinite uniform grid, rebuilt from scratch every step
+// Works best when colliders are of similar size and the cell size is close to that size, every collider then only
+// touches a handful of cells and only colliders sharing a cell are tested against each other.
+// Cells are stored in an open addressing hash table (linear probing) so no memory is allocated once the table has grown.
+// A pair sharing several cells is only reported by the cell containing the minimum corner of their overlap,
+// which removes duplicate pairs without a pair set and lets every cell be processed independently on its own thread.
+class SpatialHashGrid : public Broadphase
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	// Should be around the size of the most common collider
+	float CellSize = 2.0f;
+	// Colliders touching more cells than this are tested against every collider instead of being hashed
+	int MaxCellsPerProxy = 64;
+	bool bIsMultithreaded = true;
+	// Below this many proxies per thread the cost of starting the threads outweighs the gain
+	int MinProxiesPerThread = 512;
+private:
+	struct CellEntry
+	{
+		unsigned long long CellKey;
+		int X, Y, Z;
+		int ProxyID;
+		// Filled in once the cell has been added to the hash table
+		int CellIndex;
+	};
+
+	struct Cell
+	{
+		unsigned long long Key;
+		int X, Y, Z;
+		// Range of this cell in the cell contents list
+		int Start;
+		int Count;
+	};
+
+	// Per thread output, merged once every thread has finished
+	struct ThreadData
+	{
+		std::vector<CellEntry> EntryList;
+		std::vector<int> OversizedProxyList;
+		std::vector<ColliderPair> PairList;
+	};
+
+	static const unsigned long long EmptyKey = ~0ull;
+
+	// Indexed by collider slot, null once removed
+	std::vector<Collider *> ProxyList;
+	// Copy of the collider bounds taken at the start of the step, so the pair tests don't touch the colliders
+	std::vector<AABB> ProxyBounds;
+	std::vector<char> OversizedFlags;
+	std::vector<int> OversizedProxyList;
+
+	// Size is always a power of two
+	std::vector<Cell> HashTable;
+	// Indices into the hash table of every cell used this step
+	std::vector<int> OccupiedCellList;
+	// Proxy IDs grouped by cell
+	std::vector<int> CellContents;
+
+	std::vector<ThreadData> ThreadDataList;
+	std::vector<ColliderPair> PairList;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	virtual void AddCollider(Collider * aCollider) override;
+	virtual void RemoveCollider(Collider * aCollider) override;
+	virtual void Update() override;
+	virtual void FindOverlappingPairs(std::vector<ColliderPair> & aPairList) override;
+
+	inline int GetOccupiedCellCount() const { return (int)OccupiedCellList.size(); }
+	inline int GetOversizedProxyCount() const { return (int)OversizedProxyList.size(); }
+	inline int GetThreadCount() const { return (int)ThreadDataList.size(); }
+
+private:
+	// Fills the entry list of one thread with the cells touched by the proxies in [aBegin, aEnd)
+	void HashProxies(ThreadData & aThreadData, int aBegin, int aEnd);
+	// Finds the pairs in the occupied cells [aBegin, aEnd)
+	void FindPairsInCells(ThreadData & aThreadData, int aBegin, int aEnd);
+	// Returns the index of the cell in the hash table, adding it if it doesn't exist yet
+	int FindOrAddCell(unsigned long long aKey, int aX, int aY, int aZ);
+	// Runs aFunction(threadData, begin, end) over [0, aCount), split between threads if multithreading is enabled
+	template <typename T>
+	void ParallelFor(int aCount, T aFunction);
+
+	inline int GetCellCoordinate(float aValue) const { return (int)std::floor(aValue / CellSize); }
+	// Packs 3 cell coordinates into 21 bits each, the grid wraps around after a million cells in any direction
+	static inline unsigned long long GetCellKey(int aX, int aY, int aZ)
+	{
+		const unsigned long long mask = (1ull << 21) - 1;
+		return (((unsigned long long)aX & mask) << 42) | (((unsigned long long)aY & mask) << 21) | ((unsigned long long)aZ & mask);
+	}
+	// 64 bit finalizer from MurmurHash3, spreads neighbouring cells across the table
+	static inline unsigned long long HashCellKey(unsigned long long aKey)
+	{
+		aKey ^= aKey >> 33;
+		aKey *= 0xff51afd7ed558ccdull;
+		aKey ^= aKey >> 33;
+		aKey *= 0xc4ceb9fe1a85ec53ull;
+		aKey ^= aKey >> 33;
+		return aKey;
+	}
+};
@@ -0,0 +1,46 @@
+#include "Typedefs.h"
+#include "Sphere.h"
+#include "GameObject.h"
+#include "Transform.h"
+
+void Sphere::Initialize()
+{
+	// The support function is analytic, so unlike Box no collider mesh is imported
+	Transform & transform = *pOwner->GetComponent<Transform>();
+	vector3 scale = glm::abs(transform.Scale);
+	float radius = Radius * glm::max(scale.x, glm::max(scale.y, scale.z));
+
+	// The whole sphere is margin around its center, so any penetration shallower than the radius gets its normal without EPA
+	CollisionMargin = radius;
+
+	// Inertia tensor of a solid sphere in body space
+	InertiaTensor = glm::mat3(0.4f * radius * radius);
+}
+
+glm::vec3 Sphere::FindFarthestPointInDirection(vector3 aDirection)
+{
+	// The model matrix scales the local point along each axis, the world sphere is an ellipsoid with radii worldRadius / scale in local space
+	vector3 scale(glm::length(vector3(LocalToWorldMatrix[0])), glm::length(vector3(LocalToWorldMatrix[1])), glm::length(vector3(LocalToWorldMatrix[2])));
+	vector3 localDirection(glm::dot(vector3(LocalToWorldMatrix[0]), aDirection) / scale.x,
+						   glm::dot(vector3(LocalToWorldMatrix[1]), aDirection) / scale.y,
+						   glm::dot(vector3(LocalToWorldMatrix[2]), aDirection) / scale.z);
+	float length = glm::length(localDirection);
+	if (length == 0.0f)
+		return vector3(0);
+
+	float worldRadius = Radius * glm::max(scale.x, glm::max(scale.y, scale.z));
+	return (worldRadius / length) * localDirection / scale;
+}
+
+glm::vec3 Sphere::FindFarthestCorePointInDirection(vector3)
+{
+	return vector3(0);
+}
+
+void Sphere::UpdateBoundingBox()
+{
+	vector3 center = GetWorldCenter();
+	vector3 extents(GetWorldRadius());
+	BoundingBox.Min = center - extents;
+	BoundingBox.Max = center + extents;
+}
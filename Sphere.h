@@ -0,0 +1,27 @@
+#pragma once
+#include "Collider.h"
+class Sphere : public Collider
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	// Local space, scaled by the largest component of the transform scale
+	float Radius = 1.0f;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	Sphere() :
+		Collider(Collider::SPHERE) {}
+	virtual void Initialize() override;
+	virtual void Deserialize(TextFileData & aTextData) override {};
+	virtual void Serialize(TextFileData & aTextData) override {};
+
+	virtual vector3 FindFarthestPointInDirection(glm::vec3 aDirection);
+	virtual vector3 FindFarthestCorePointInDirection(glm::vec3 aDirection) override;
+	virtual void UpdateBoundingBox() override;
+
+	// Model matrix must be up to date
+	inline vector3 GetWorldCenter() const { return vector3(LocalToWorldMatrix[3]); }
+	inline float GetWorldRadius() const
+	{
+		return Radius * glm::max(glm::length(vector3(LocalToWorldMatrix[0])), glm::max(glm::length(vector3(LocalToWorldMatrix[1])), glm::length(vector3(LocalToWorldMatrix[2]))));
+	}
+};
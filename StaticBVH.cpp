@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <limits>
+#include "StaticBVH.h"
+#include "Collider.h"
+
+void StaticBVH::Build(const std::vector<Collider *> & aColliders)
+{
+	Clear();
+	if (aColliders.empty())
+		return;
+
+	std::vector<BuildPrimitive> buildList;
+	buildList.reserve(aColliders.size());
+	for (Collider * collider : aColliders)
+		buildList.push_back({ collider, collider->BoundingBox, collider->BoundingBox.GetCenter() });
+
+	// A binary tree with N leaves has 2N - 1 nodes, leaves holding several primitives only make it smaller
+	Nodes.reserve(2 * buildList.size());
+	BuildRecursive(buildList, 0, (int)buildList.size(), 0);
+
+	// The build list has been reordered so that each leaf covers a contiguous range
+	Primitives.reserve(buildList.size());
+	PrimitiveBounds.reserve(buildList.size());
+	for (BuildPrimitive & primitive : buildList)
+	{
+		Primitives.push_back(primitive.pCollider);
+		PrimitiveBounds.push_back(primitive.Bounds);
+	}
+}
+
+void StaticBVH::Clear()
+{
+	Nodes.clear();
+	Primitives.clear();
+	PrimitiveBounds.clear();
+	Depth = 0;
+}
+
+int StaticBVH::BuildRecursive(std::vector<BuildPrimitive> & aBuildList, int aBegin, int aEnd, int aDepth)
+{
+	Depth = std::max(Depth, aDepth);
+
+	int nodeID = (int)Nodes.size();
+	Nodes.emplace_back();
+
+	AABB bounds = aBuildList[aBegin].Bounds;
+	AABB centroidBounds(aBuildList[aBegin].Centroid, aBuildList[aBegin].Centroid);
+	for (int i = aBegin + 1; i < aEnd; ++i)
+	{
+		bounds = AABB::Merge(bounds, aBuildList[i].Bounds);
+		centroidBounds = AABB::Merge(centroidBounds, AABB(aBuildList[i].Centroid, aBuildList[i].Centroid));
+	}
+	Nodes[nodeID].Bounds = bounds;
+
+	int primitiveCount = aEnd - aBegin;
+	if (primitiveCount <= MaxPrimitivesPerLeaf || aDepth >= MaxDepth)
+	{
+		Nodes[nodeID].Offset = aBegin;
+		Nodes[nodeID].PrimitiveCount = primitiveCount;
+		return nodeID;
+	}
+
+	// Split along the axis with the widest spread of centroids
+	vector3 centroidExtent = centroidBounds.Max - centroidBounds.Min;
+	int axis = 0;
+	if (centroidExtent.y > centroidExtent[axis])
+		axis = 1;
+	if (centroidExtent.z > centroidExtent[axis])
+		axis = 2;
+
+	int middle = aBegin;
+	if (centroidExtent[axis] > 0.0f)
+	{
+		struct Bin
+		{
+			AABB Bounds;
+			int Count = 0;
+		};
+		Bin bins[BinCount];
+
+		float binScale = BinCount / centroidExtent[axis];
+		auto getBinIndex = [&](const BuildPrimitive & aPrimitive)
+		{
+			int binIndex = (int)((aPrimitive.Centroid[axis] - centroidBounds.Min[axis]) * binScale);
+			return std::min(binIndex, BinCount - 1);
+		};
+
+		for (int i = aBegin; i < aEnd; ++i)
+		{
+			Bin & bin = bins[getBinIndex(aBuildList[i])];
+			bin.Bounds = (bin.Count == 0) ? aBuildList[i].Bounds : AABB::Merge(bin.Bounds, aBuildList[i].Bounds);
+			++bin.Count;
+		}
+
+		// Sweep from the right first so the cost of every split plane can be found in a second sweep from the left
+		float rightArea[BinCount];
+		int rightCount[BinCount];
+		AABB sweepBounds;
+		int sweepCount = 0;
+		for (int i = BinCount - 1; i > 0; --i)
+		{
+			if (bins[i].Count > 0)
+				sweepBounds = (sweepCount == 0) ? bins[i].Bounds : AABB::Merge(sweepBounds, bins[i].Bounds);
+			sweepCount += bins[i].Count;
+			rightArea[i] = sweepBounds.SurfaceArea();
+			rightCount[i] = sweepCount;
+		}
+
+		// Split plane i separates bins [0, i) from bins [i, BinCount)
+		int bestSplit = -1;
+		float bestCost = std::numeric_limits<float>::max();
+		sweepCount = 0;
+		for (int i = 1; i < BinCount; ++i)
+		{
+			if (bins[i - 1].Count > 0)
+				sweepBounds = (sweepCount == 0) ? bins[i - 1].Bounds : AABB::Merge(sweepBounds, bins[i - 1].Bounds);
+			sweepCount += bins[i - 1].Count;
+			if (sweepCount == 0 || rightCount[i] == 0)
+				continue;
+
+			float cost = sweepCount * sweepBounds.SurfaceArea() + rightCount[i] * rightArea[i];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplit = i;
+			}
+		}
+
+		if (bestSplit != -1)
+		{
+			auto splitIterator = std::partition(aBuildList.begin() + aBegin, aBuildList.begin() + aEnd,
+				[&](const BuildPrimitive & aPrimitive) { return getBinIndex(aPrimitive) < bestSplit; });
+			middle = (int)(splitIterator - aBuildList.begin());
+		}
+	}
+
+	// All centroids in one bin (or at the same point), fall back to splitting the primitives in half
+	if (middle == aBegin || middle == aEnd)
+	{
+		middle = (aBegin + aEnd) / 2;
+		std::nth_element(aBuildList.begin() + aBegin, aBuildList.begin() + middle, aBuildList.begin() + aEnd,
+			[axis](const BuildPrimitive & aPrimitiveA, const BuildPrimitive & aPrimitiveB) { return aPrimitiveA.Centroid[axis] < aPrimitiveB.Centroid[axis]; });
+	}
+
+	// Left child is always the next node, only the right child needs to be stored
+	BuildRecursive(aBuildList, aBegin, middle, aDepth + 1);
+	Nodes[nodeID].Offset = BuildRecursive(aBuildList, middle, aEnd, aDepth + 1);
+	return nodeID;
+}
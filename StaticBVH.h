@@ -0,0 +1,94 @@
+#pragma once
+#include <vector>
+#include "PhysicsUtilities.h"
+
+class Collider;
+
+// Immutable bounding volume hierarchy over the static colliders, built once after the level has loaded
+// Splits are chosen with a binned surface area heuristic (SAH) as described in PBRT (4.3.2).
+// Nodes are flattened depth first into a single array so the left child of an internal node is always the next node,
+// and every leaf references a contiguous range of the primitive arrays.
+class StaticBVH
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	struct LinearNode
+	{
+		AABB Bounds;
+		// Index of the right child for internal nodes, index of the first primitive for leaves
+		int Offset = 0;
+		// Zero for internal nodes
+		int PrimitiveCount = 0;
+
+		inline bool IsLeaf() const { return PrimitiveCount > 0; }
+	};
+
+	// Number of buckets the centroid range is divided into when evaluating split costs
+	static const int BinCount = 12;
+	// Nodes are not split any further past this depth, bounds the size of the query stack
+	static const int MaxDepth = 48;
+	// Nodes holding this many primitives or fewer become leaves
+	int MaxPrimitivesPerLeaf = 4;
+private:
+	// Used only while building
+	struct BuildPrimitive
+	{
+		Collider * pCollider;
+		AABB Bounds;
+		vector3 Centroid;
+	};
+
+	std::vector<LinearNode> Nodes;
+	// Bounds are stored apart from the colliders so leaf tests don't have to touch the colliders at all
+	std::vector<Collider *> Primitives;
+	std::vector<AABB> PrimitiveBounds;
+	int Depth = 0;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	// Every collider must already have an up to date BoundingBox
+	void Build(const std::vector<Collider *> & aColliders);
+	void Clear();
+
+	inline bool IsEmpty() const { return Nodes.empty(); }
+	inline int GetNodeCount() const { return (int)Nodes.size(); }
+	inline int GetPrimitiveCount() const { return (int)Primitives.size(); }
+	inline int GetDepth() const { return Depth; }
+
+	// Calls aCallback(collider) for every static collider whose bounds overlap aBounds, stops early if the callback returns false
+	template <typename T>
+	void Query(const AABB & aBounds, T & aCallback) const
+	{
+		if (Nodes.empty())
+			return;
+
+		int stack[MaxDepth + 2];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0)
+		{
+			int nodeID = stack[--stackSize];
+			const LinearNode & node = Nodes[nodeID];
+			if (node.Bounds.Overlaps(aBounds) == false)
+				continue;
+
+			if (node.IsLeaf())
+			{
+				for (int i = node.Offset; i < node.Offset + node.PrimitiveCount; ++i)
+				{
+					if (PrimitiveBounds[i].Overlaps(aBounds) && aCallback(Primitives[i]) == false)
+						return;
+				}
+			}
+			else
+			{
+				// Left child is pushed last so it is visited first, it sits right after this node in memory
+				stack[stackSize++] = node.Offset;
+				stack[stackSize++] = nodeID + 1;
+			}
+		}
+	}
+
+private:
+	// Builds the subtree for the primitives in [aBegin, aEnd), returns the index of its root node
+	int BuildRecursive(std::vector<BuildPrimitive> & aBuildList, int aBegin, int aEnd, int aDepth);
+};
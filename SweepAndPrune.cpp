@@ -0,0 +1,246 @@
+#include <algorithm>
+#include "SweepAndPrune.h"
+#include "Collider.h"
+
+void SweepAndPrune::AddCollider(Collider * aCollider)
+{
+	int proxyID = aCollider->ColliderSlot;
+	if (proxyID >= (int)ProxyList.size())
+		ProxyList.resize(proxyID + 1);
+
+	Proxy & newProxy = ProxyList[proxyID];
+	newProxy.pCollider = aCollider;
+
+	// Append the endpoints at the end of each list and sort them down into place
+	// Overlaps only need to be tracked on the last axis, by then the other two axes are already sorted
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		std::vector<Endpoint> & endpoints = EndpointList[axis];
+
+		newProxy.MinEndpoint[axis] = (int)endpoints.size();
+		endpoints.push_back({ aCollider->BoundingBox.Min[axis], proxyID, true });
+		newProxy.MaxEndpoint[axis] = (int)endpoints.size();
+		endpoints.push_back({ aCollider->BoundingBox.Max[axis], proxyID, false });
+
+		bool bShouldUpdateOverlaps = (axis == 2);
+		SortMinDown(axis, newProxy.MinEndpoint[axis], bShouldUpdateOverlaps);
+		SortMaxDown(axis, newProxy.MaxEndpoint[axis], bShouldUpdateOverlaps);
+	}
+}
+
+void SweepAndPrune::RemoveCollider(Collider * aCollider)
+{
+	int proxyID = aCollider->ColliderSlot;
+	if (proxyID >= (int)ProxyList.size() || ProxyList[proxyID].pCollider == nullptr)
+		return;
+
+	// Drop every pair this proxy is a part of
+	for (auto iterator = OverlappingPairs.begin(); iterator != OverlappingPairs.end();)
+	{
+		int proxyA = GetFirstProxyID(*iterator);
+		int proxyB = GetSecondProxyID(*iterator);
+		if (proxyA == proxyID || proxyB == proxyID)
+		{
+			iterator = OverlappingPairs.erase(iterator);
+			continue;
+		}
+		++iterator;
+	}
+
+	Proxy & proxy = ProxyList[proxyID];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		std::vector<Endpoint> & endpoints = EndpointList[axis];
+		// Max endpoint is always after the min endpoint, erase it first so the min index stays valid
+		endpoints.erase(endpoints.begin() + proxy.MaxEndpoint[axis]);
+		endpoints.erase(endpoints.begin() + proxy.MinEndpoint[axis]);
+
+		// Every endpoint after the removed min endpoint has shifted down
+		for (int i = proxy.MinEndpoint[axis]; i < (int)endpoints.size(); ++i)
+		{
+			Proxy & shiftedProxy = ProxyList[endpoints[i].ProxyID];
+			if (endpoints[i].bIsMin)
+				shiftedProxy.MinEndpoint[axis] = i;
+			else
+				shiftedProxy.MaxEndpoint[axis] = i;
+		}
+	}
+	proxy.pCollider = nullptr;
+}
+
+void SweepAndPrune::Update()
+{
+	for (int i = 0; i < (int)ProxyList.size(); ++i)
+	{
+		if (ProxyList[i].pCollider)
+			UpdateProxy(i, ProxyList[i].pCollider->BoundingBox);
+	}
+}
+
+void SweepAndPrune::FindOverlappingPairs(std::vector<ColliderPair>& aPairList)
+{
+	aPairList.reserve(aPairList.size() + OverlappingPairs.size());
+	for (unsigned long long pairKey : OverlappingPairs)
+	{
+		int proxyA = GetFirstProxyID(pairKey);
+		int proxyB = GetSecondProxyID(pairKey);
+		aPairList.emplace_back(ProxyList[proxyA].pCollider, ProxyList[proxyB].pCollider);
+	}
+}
+
+void SweepAndPrune::UpdateProxy(int aProxyID, const AABB & aBounds)
+{
+	Proxy & proxy = ProxyList[aProxyID];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		Endpoint & minEndpoint = EndpointList[axis][proxy.MinEndpoint[axis]];
+		Endpoint & maxEndpoint = EndpointList[axis][proxy.MaxEndpoint[axis]];
+
+		float deltaMin = aBounds.Min[axis] - minEndpoint.Value;
+		float deltaMax = aBounds.Max[axis] - maxEndpoint.Value;
+		minEndpoint.Value = aBounds.Min[axis];
+		maxEndpoint.Value = aBounds.Max[axis];
+
+		// Grow the bounds first (can only add overlaps), then shrink them (can only remove overlaps)
+		if (deltaMin < 0.0f)
+			SortMinDown(axis, proxy.MinEndpoint[axis], true);
+		if (deltaMax > 0.0f)
+			SortMaxUp(axis, proxy.MaxEndpoint[axis], true);
+		if (deltaMin > 0.0f)
+			SortMinUp(axis, proxy.MinEndpoint[axis], true);
+		if (deltaMax < 0.0f)
+			SortMaxDown(axis, proxy.MaxEndpoint[axis], true);
+	}
+}
+
+void SweepAndPrune::SortMinDown(int aAxis, int aEndpointIndex, bool aShouldUpdateOverlaps)
+{
+	std::vector<Endpoint> & endpoints = EndpointList[aAxis];
+	Proxy & proxy = ProxyList[endpoints[aEndpointIndex].ProxyID];
+
+	int index = aEndpointIndex;
+	while (index > 0 && endpoints[index].Value < endpoints[index - 1].Value)
+	{
+		Endpoint & previous = endpoints[index - 1];
+		Proxy & previousProxy = ProxyList[previous.ProxyID];
+		if (previous.bIsMin)
+		{
+			previousProxy.MinEndpoint[aAxis]++;
+		}
+		else
+		{
+			// Min moved below another max, the two proxies now overlap on this axis
+			if (aShouldUpdateOverlaps && TestOverlapOnOtherAxes(aAxis, proxy, previousProxy))
+				AddPair(previous.ProxyID, endpoints[index].ProxyID);
+			previousProxy.MaxEndpoint[aAxis]++;
+		}
+		proxy.MinEndpoint[aAxis]--;
+		std::swap(endpoints[index], endpoints[index - 1]);
+		--index;
+	}
+}
+
+void SweepAndPrune::SortMinUp(int aAxis, int aEndpointIndex, bool aShouldUpdateOverlaps)
+{
+	std::vector<Endpoint> & endpoints = EndpointList[aAxis];
+	Proxy & proxy = ProxyList[endpoints[aEndpointIndex].ProxyID];
+
+	int index = aEndpointIndex;
+	int lastIndex = (int)endpoints.size() - 1;
+	while (index < lastIndex && endpoints[index + 1].Value < endpoints[index].Value)
+	{
+		Endpoint & next = endpoints[index + 1];
+		Proxy & nextProxy = ProxyList[next.ProxyID];
+		if (next.bIsMin)
+		{
+			nextProxy.MinEndpoint[aAxis]--;
+		}
+		else
+		{
+			// Min moved above another max, the two proxies stop overlapping on this axis
+			if (aShouldUpdateOverlaps && TestOverlapOnOtherAxes(aAxis, proxy, nextProxy))
+				RemovePair(next.ProxyID, endpoints[index].ProxyID);
+			nextProxy.MaxEndpoint[aAxis]--;
+		}
+		proxy.MinEndpoint[aAxis]++;
+		std::swap(endpoints[index], endpoints[index + 1]);
+		++index;
+	}
+}
+
+void SweepAndPrune::SortMaxDown(int aAxis, int aEndpointIndex, bool aShouldUpdateOverlaps)
+{
+	std::vector<Endpoint> & endpoints = EndpointList[aAxis];
+	Proxy & proxy = ProxyList[endpoints[aEndpointIndex].ProxyID];
+
+	int index = aEndpointIndex;
+	while (index > 0 && endpoints[index].Value < endpoints[index - 1].Value)
+	{
+		Endpoint & previous = endpoints[index - 1];
+		Proxy & previousProxy = ProxyList[previous.ProxyID];
+		if (previous.bIsMin)
+		{
+			// Max moved below another min, the two proxies stop overlapping on this axis
+			if (aShouldUpdateOverlaps && TestOverlapOnOtherAxes(aAxis, proxy, previousProxy))
+				RemovePair(previous.ProxyID, endpoints[index].ProxyID);
+			previousProxy.MinEndpoint[aAxis]++;
+		}
+		else
+		{
+			previousProxy.MaxEndpoint[aAxis]++;
+		}
+		proxy.MaxEndpoint[aAxis]--;
+		std::swap(endpoints[index], endpoints[index - 1]);
+		--index;
+	}
+}
+
+void SweepAndPrune::SortMaxUp(int aAxis, int aEndpointIndex, bool aShouldUpdateOverlaps)
+{
+	std::vector<Endpoint> & endpoints = EndpointList[aAxis];
+	Proxy & proxy = ProxyList[endpoints[aEndpointIndex].ProxyID];
+
+	int index = aEndpointIndex;
+	int lastIndex = (int)endpoints.size() - 1;
+	while (index < lastIndex && endpoints[index + 1].Value < endpoints[index].Value)
+	{
+		Endpoint & next = endpoints[index + 1];
+		Proxy & nextProxy = ProxyList[next.ProxyID];
+		if (next.bIsMin)
+		{
+			// Max moved above another min, the two proxies now overlap on this axis
+			if (aShouldUpdateOverlaps && TestOverlapOnOtherAxes(aAxis, proxy, nextProxy))
+				AddPair(next.ProxyID, endpoints[index].ProxyID);
+			nextProxy.MinEndpoint[aAxis]--;
+		}
+		else
+		{
+			nextProxy.MaxEndpoint[aAxis]--;
+		}
+		proxy.MaxEndpoint[aAxis]++;
+		std::swap(endpoints[index], endpoints[index + 1]);
+		++index;
+	}
+}
+
+bool SweepAndPrune::TestOverlapOnOtherAxes(int aAxis, const Proxy & aProxyA, const Proxy & aProxyB)
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (axis == aAxis)
+			continue;
+		if (aProxyA.MaxEndpoint[axis] < aProxyB.MinEndpoint[axis] || aProxyB.MaxEndpoint[axis] < aProxyA.MinEndpoint[axis])
+			return false;
+	}
+	return true;
+}
+
+void SweepAndPrune::AddPair(int aProxyA, int aProxyB)
+{
+	OverlappingPairs.insert(GetPairKey(aProxyA, aProxyB));
+}
+
+void SweepAndPrune::RemovePair(int aProxyA, int aProxyB)
+{
+	OverlappingPairs.erase(GetPairKey(aProxyA, aProxyB));
+}
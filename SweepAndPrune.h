@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <unordered_set>
+#include "Broadphase.h"
+
+// Incremental sweep-and-prune broadphase, based on the axis sweep used in Bullet (btAxisSweep3)
+// http://www.codercorner.com/SAP.pdf
+// One sorted list of AABB endpoints is kept per axis. Between frames the lists are re-sorted with an insertion sort,
+// which is close to O(n) because bodies barely move from one frame to the next (temporal coherence).
+// Every time a min endpoint is swapped past a max endpoint an overlap starts or ends on that axis,
+// so the set of overlapping pairs is updated during the sort instead of being rebuilt every frame.
+class SweepAndPrune : public Broadphase
+{
+	/*-----------MEMBER VARIABLES-----------*/
+public:
+	struct Endpoint
+	{
+		float Value;
+		// Collider slot of the proxy that owns this endpoint
+		int ProxyID;
+		bool bIsMin;
+	};
+
+	struct Proxy
+	{
+		Collider * pCollider = nullptr;
+		// Position of each endpoint in the endpoint list of each axis
+		int MinEndpoint[3];
+		int MaxEndpoint[3];
+	};
+private:
+	std::vector<Endpoint> EndpointList[3];
+	// Indexed by collider slot
+	std::vector<Proxy> ProxyList;
+	// Key is the two proxy IDs packed together, lower ID in the high bits
+	std::unordered_set<unsigned long long> OverlappingPairs;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	virtual void AddCollider(Collider * aCollider) override;
+	virtual void RemoveCollider(Collider * aCollider) override;
+	virtual void Update() override;
+	virtual void FindOverlappingPairs(std::vector<ColliderPair> & aPairList) override;
+
+	inline int GetOverlappingPairCount() { return (int)OverlappingPairs.size(); }
+
+private:
+	void UpdateProxy(int aProxyID, const AABB & aBounds);
+
+	// Insertion sort steps, each one moves a single endpoint until its list is sorted again
+	void SortMinDown(int aAxis, int aEndpointIndex, bool aShouldUpdateOverlaps);
+	void SortMinUp(int aAxis, int aEndpointIndex, bool aShouldUpdateOverlaps);
+	void SortMaxDown(int aAxis, int aEndpointIndex, bool aShouldUpdateOverlaps);
+	void SortMaxUp(int aAxis, int aEndpointIndex, bool aShouldUpdateOverlaps);
+
+	// Uses endpoint positions instead of values, so it is valid while the lists are partially sorted
+	bool TestOverlapOnOtherAxes(int aAxis, const Proxy & aProxyA, const Proxy & aProxyB);
+
+	void AddPair(int aProxyA, int aProxyB);
+	void RemovePair(int aProxyA, int aProxyB);
+};
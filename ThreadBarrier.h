@@ -0,0 +1,33 @@
+#pragma once
+#include <mutex>
+#include <condition_variable>
+
+// Blocks the threads that call Wait until aThreadCount of them have, then releases them all and resets for the next use
+class ThreadBarrier
+{
+	/*-----------MEMBER VARIABLES-----------*/
+private:
+	std::mutex Mutex;
+	std::condition_variable Condition;
+	int ThreadCount;
+	int WaitingCount = 0;
+	// Incremented every time the barrier opens, so a thread that is already waiting on the next use isn't released early
+	unsigned int Generation = 0;
+	/*-----------MEMBER FUNCTIONS-----------*/
+public:
+	ThreadBarrier(int aThreadCount) : ThreadCount(aThreadCount) {}
+
+	void Wait()
+	{
+		std::unique_lock<std::mutex> lock(Mutex);
+		unsigned int generation = Generation;
+		if (++WaitingCount == ThreadCount)
+		{
+			WaitingCount = 0;
+			++Generation;
+			Condition.notify_all();
+			return;
+		}
+		Condition.wait(lock, [this, generation]() { return Generation != generation; });
+	}
+};
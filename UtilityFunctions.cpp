@@ -7,23 +7,21 @@
 #include "GameObject.h"
 #include "Mesh.h"
 
-// aDirection doesn't need to be normalized
 SupportPoint Utility::Support(Collider * aShape1, Collider * aShape2, vector3 aDirection, matrix4 & aModel1, matrix4 & aModel2)
 {
-	SupportPoint newSupportPoint;
-	aDirection = glm::normalize(aDirection);
-
-	// Get points on edge of the shapes in opposite directions, in object space
-	newSupportPoint.Local_SupportPointA = aShape1->FindFarthestPointInDirection(aDirection);
-	newSupportPoint.Local_SupportPointB = aShape2->FindFarthestPointInDirection(-aDirection);
-	
-	// Convert to world space
-	newSupportPoint.World_SupportPointA = vector3(aModel1 * glm::vec4(newSupportPoint.Local_SupportPointA, 1));
-	newSupportPoint.World_SupportPointB = vector3(aModel2 * glm::vec4(newSupportPoint.Local_SupportPointB, 1));
+	// Get points on edge of the shapes in opposite directions, in object space, then convert to world space and perform the Minkowski Difference
+	return SupportFromLocalPoints(aShape1->FindFarthestPointInDirection(aDirection), aShape2->FindFarthestPointInDirection(-aDirection), aModel1, aModel2);
+}
 
-	// Perform the Minkowski Difference
-	newSupportPoint.MinkowskiHullVertex = newSupportPoint.World_SupportPointA - newSupportPoint.World_SupportPointB;
-	return newSupportPoint;
+SupportPoint Utility::SupportFromLocalPoints(const vector3 & aLocalPointA, const vector3 & aLocalPointB, matrix4 & aModel1, matrix4 & aModel2)
+{
+	SupportPoint supportPoint;
+	supportPoint.Local_SupportPointA = aLocalPointA;
+	supportPoint.Local_SupportPointB = aLocalPointB;
+	supportPoint.World_SupportPointA = vector3(aModel1 * glm::vec4(aLocalPointA, 1));
+	supportPoint.World_SupportPointB = vector3(aModel2 * glm::vec4(aLocalPointB, 1));
+	supportPoint.MinkowskiHullVertex = supportPoint.World_SupportPointA - supportPoint.World_SupportPointB;
+	return supportPoint;
 }
 
 void Utility::CalculateMinkowskiDifference(std::vector<Vertex>& aMinkowskiDifference, Mesh * aShape1, Mesh * aShape2)
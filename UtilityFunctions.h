@@ -1,6 +1,5 @@
 #pragma once
 #include <glm/glm.hpp>
-#include <list>
 #include "Collider.h"
 #include "Vertex.h"
 #include "PhysicsUtilities.h"
@@ -34,6 +33,28 @@ namespace Utility
 
 	// aDirection doesn't need to be normalized
 	SupportPoint Support(Collider * aShape1, Collider * aShape2, glm::vec3 aDirection, glm:: mat4 & aModel1, glm::mat4 & aModel2);
+	// Rebuilds a support point from object space points found earlier, used to carry a simplex over to the next step
+	SupportPoint SupportFromLocalPoints(const glm::vec3 & aLocalPointA, const glm::vec3 & aLocalPointB, glm::mat4 & aModel1, glm::mat4 & aModel2);
+
+	// Uses the same faces and winding as EPA, so a tetrahedron that passes can be handed to EPA as it is
+	inline bool IsOriginInsideTetrahedron(const Simplex & aSimplex)
+	{
+		const SupportPoint * faces[4][3] = {
+			{ &aSimplex.Vertices[0], &aSimplex.Vertices[1], &aSimplex.Vertices[2] },
+			{ &aSimplex.Vertices[0], &aSimplex.Vertices[2], &aSimplex.Vertices[3] },
+			{ &aSimplex.Vertices[0], &aSimplex.Vertices[3], &aSimplex.Vertices[1] },
+			{ &aSimplex.Vertices[1], &aSimplex.Vertices[3], &aSimplex.Vertices[2] } };
+
+		for (int i = 0; i < 4; ++i)
+		{
+			glm::vec3 a = faces[i][0]->MinkowskiHullVertex;
+			glm::vec3 normal = glm::cross(faces[i][1]->MinkowskiHullVertex - a, faces[i][2]->MinkowskiHullVertex - a);
+			// The origin has to be strictly behind every outward facing face, a flat tetrahedron fails as well
+			if (glm::dot(normal, a) <= 0.0f)
+				return false;
+		}
+		return true;
+	}
 
 	// Note that the following triple product expansion is used :
 	// (A x B) x C = B(C.dot(A))  A(C.dot(B)) to evaluate the triple product.
@@ -42,25 +63,6 @@ namespace Utility
 	}
 	
 
-	// Process the specified edge, if another edge with the same points in the
-	// opposite order exists then it is removed and the new point is also not added
-	// "The trick is that if two triangles that are removed share an edge then that edge is gone for good, 
-	// but if an edge is used by only one removed triangle then it will form part of the hole."
-
-	inline  void AddEdge(std::list<PolytopeEdge> & aEdgeList, const SupportPoint & a, const SupportPoint & b)
-	{
-		for (auto iterator = aEdgeList.begin(); iterator != aEdgeList.end(); ++iterator)
-		{
-			if (iterator->Points[0] == b && iterator->Points[1] == a)
-			{
-				// Encountered the same edge with opposite winding, remove it and don't add a new one
-				aEdgeList.erase(iterator);
-				return;
-			}
-		}
-		aEdgeList.emplace_back(a, b);
-	}
-
 	// Code from Christer Ericson's Real-Time Collision Detection
 	// Compute barycentric coordinates (u, v, w) for
 	// point p with respect to triangle (a, b, c)